@@ -159,6 +159,8 @@ int AAS_StartFrame(float time)
 	AAS_InvalidateEntities();
 	//initialize AAS
 	AAS_ContinueInit(time);
+	//build routing cache in the background once AAS is initialized
+	AAS_ContinuePrecomputeRoutingCache();
 	//
 	aasworld.frameroutingupdates = 0;
 	//
@@ -88,6 +88,13 @@ int numportalcacheupdates;
 
 int routingcachesize;
 int max_routingcachesize;
+//routing cache statistics, reset when the routing is initialized
+int routingcachehits;
+int routingcachemisses;
+int routingcacheevictions;
+//incremental routing cache precomputation
+int routingprecomputearea;
+int routingprecomputetime;
 
 //===========================================================================
 //
@@ -101,6 +108,15 @@ void AAS_RoutingInfo(void)
 	botimport.Print(PRT_MESSAGE, "%d area cache updates\n", numareacacheupdates);
 	botimport.Print(PRT_MESSAGE, "%d portal cache updates\n", numportalcacheupdates);
 	botimport.Print(PRT_MESSAGE, "%d bytes routing cache\n", routingcachesize);
+	botimport.Print(PRT_MESSAGE, "%d cache hits, %d cache misses, %d caches evicted\n",
+		routingcachehits, routingcachemisses, routingcacheevictions);
+} //end of the function AAS_RoutingInfo
+#else
+void AAS_RoutingInfo(void)
+{
+	botimport.Print(PRT_MESSAGE, "%d bytes routing cache\n", routingcachesize);
+	botimport.Print(PRT_MESSAGE, "%d cache hits, %d cache misses, %d caches evicted\n",
+		routingcachehits, routingcachemisses, routingcacheevictions);
 } //end of the function AAS_RoutingInfo
 #endif //ROUTING_DEBUG
 //===========================================================================
@@ -729,6 +745,7 @@ int AAS_FreeOldestCache(void)
 			if (cache->next) cache->next->prev = cache->prev;
 		}
 		AAS_FreeRoutingCache(cache);
+		routingcacheevictions++;
 		return qtrue;
 	}
 	return qfalse;
@@ -921,51 +938,68 @@ void AAS_CreateAllRoutingCache(void)
 //===========================================================================
 
 //the route cache header
-//this header is followed by numportalcache + numareacache aas_routingcache_t
-//structures that store routing cache
+//this header is followed by numcaches routecacherecord_t structures, each
+//followed by the travel times and reachabilities of the cache, stored from
+//the least to the most recently used cache
 typedef struct routecacheheader_s
 {
 	int ident;
 	int version;
 	int numareas;
 	int numclusters;
+	int numportals;
 	int areacrc;
 	int clustercrc;
-	int numportalcache;
-	int numareacache;
+	int numcaches;
 } routecacheheader_t;
 
+//a single routing cache as stored in the route cache file
+//NOTE: the in memory aas_routingcache_t holds pointers so it can't be dumped as is
+typedef struct routecacherecord_s
+{
+	int type;
+	int cluster;
+	int areanum;
+	vec3_t origin;
+	float starttraveltime;
+	int travelflags;
+	int numtraveltimes;
+} routecacherecord_t;
+
 #define RCID						(('C'<<24)+('R'<<16)+('E'<<8)+'M')
-#define RCVERSION					2
+#define RCVERSION					3
 
+//===========================================================================
+// returns the number of travel times stored in a cache of the given type
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+static int AAS_RoutingCacheNumTravelTimes(int type, int cluster)
+{
+	if (type == CACHETYPE_AREA) return aasworld.clusters[cluster].numreachabilityareas;
+	return aasworld.numportals;
+} //end of the function AAS_RoutingCacheNumTravelTimes
+//===========================================================================
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
 void AAS_WriteRouteCache(void)
 {
-	int i, j, numportalcache, numareacache, totalsize;
+	int numcaches, totalsize;
 	aas_routingcache_t *cache;
-	aas_cluster_t *cluster;
 	fileHandle_t fp;
 	char filename[MAX_QPATH];
 	routecacheheader_t routecacheheader;
+	routecacherecord_t record;
 
-	numportalcache = 0;
-	for (i = 0; i < aasworld.numareas; i++)
+	numcaches = 0;
+	for (cache = aasworld.oldestcache; cache; cache = cache->time_next)
 	{
-		for (cache = aasworld.portalcache[i]; cache; cache = cache->next)
-		{
-			numportalcache++;
-		} //end for
-	} //end for
-	numareacache = 0;
-	for (i = 0; i < aasworld.numclusters; i++)
-	{
-		cluster = &aasworld.clusters[i];
-		for (j = 0; j < cluster->numareas; j++)
-		{
-			for (cache = aasworld.clusterareacache[i][j]; cache; cache = cache->next)
-			{
-				numareacache++;
-			} //end for
-		} //end for
+		numcaches++;
 	} //end for
 	// open the file for writing
 	Com_sprintf(filename, MAX_QPATH, "maps/%s.rcd", aasworld.mapname);
@@ -980,73 +1014,94 @@ void AAS_WriteRouteCache(void)
 	routecacheheader.version = RCVERSION;
 	routecacheheader.numareas = aasworld.numareas;
 	routecacheheader.numclusters = aasworld.numclusters;
+	routecacheheader.numportals = aasworld.numportals;
 	routecacheheader.areacrc = CRC_ProcessString( (unsigned char *)aasworld.areas, sizeof(aas_area_t) * aasworld.numareas );
 	routecacheheader.clustercrc = CRC_ProcessString( (unsigned char *)aasworld.clusters, sizeof(aas_cluster_t) * aasworld.numclusters );
-	routecacheheader.numportalcache = numportalcache;
-	routecacheheader.numareacache = numareacache;
+	routecacheheader.numcaches = numcaches;
 	//write the header
 	botimport.FS_Write(&routecacheheader, sizeof(routecacheheader_t), fp);
 	//
 	totalsize = 0;
-	//write all the cache
-	for (i = 0; i < aasworld.numareas; i++)
-	{
-		for (cache = aasworld.portalcache[i]; cache; cache = cache->next)
-		{
-			botimport.FS_Write(cache, cache->size, fp);
-			totalsize += cache->size;
-		} //end for
+	//write all the cache, least recently used first so reading it back
+	//restores the eviction order
+	for (cache = aasworld.oldestcache; cache; cache = cache->time_next)
+	{
+		Com_Memset(&record, 0, sizeof(routecacherecord_t));
+		record.type = cache->type;
+		record.cluster = cache->cluster;
+		record.areanum = cache->areanum;
+		VectorCopy(cache->origin, record.origin);
+		record.starttraveltime = cache->starttraveltime;
+		record.travelflags = cache->travelflags;
+		record.numtraveltimes = AAS_RoutingCacheNumTravelTimes(cache->type, cache->cluster);
+		botimport.FS_Write(&record, sizeof(routecacherecord_t), fp);
+		botimport.FS_Write(cache->traveltimes, record.numtraveltimes * sizeof(unsigned short int), fp);
+		botimport.FS_Write(cache->reachabilities, record.numtraveltimes * sizeof(unsigned char), fp);
+		totalsize += cache->size;
 	} //end for
-	for (i = 0; i < aasworld.numclusters; i++)
-	{
-		cluster = &aasworld.clusters[i];
-		for (j = 0; j < cluster->numareas; j++)
-		{
-			for (cache = aasworld.clusterareacache[i][j]; cache; cache = cache->next)
-			{
-				botimport.FS_Write(cache, cache->size, fp);
-				totalsize += cache->size;
-			} //end for
-		} //end for
-	} //end for
-	// write the visareas
-	/*
-	for (i = 0; i < aasworld.numareas; i++)
-	{
-		if (!aasworld.areavisibility[i]) {
-			size = 0;
-			botimport.FS_Write(&size, sizeof(int), fp);
-			continue;
-		}
-		AAS_DecompressVis( aasworld.areavisibility[i], aasworld.numareas, aasworld.decompressedvis );
-		size = AAS_CompressVis( aasworld.decompressedvis, aasworld.numareas, aasworld.decompressedvis );
-		botimport.FS_Write(&size, sizeof(int), fp);
-		botimport.FS_Write(aasworld.decompressedvis, size, fp);
-	}
-	*/
 	//
 	botimport.FS_FCloseFile(fp);
 	botimport.Print(PRT_MESSAGE, "\nroute cache written to %s\n", filename);
-	botimport.Print(PRT_MESSAGE, "written %d bytes of routing cache\n", totalsize);
+	botimport.Print(PRT_MESSAGE, "written %d routing caches, %d bytes\n", numcaches, totalsize);
 } //end of the function AAS_WriteRouteCache
 //===========================================================================
+// reads a single routing cache and links it into the cluster or portal
+// cache and the time sorted cache list
 //
 // Parameter:			-
-// Returns:				-
+// Returns:				qfalse if the record is invalid for the loaded AAS
 // Changes Globals:		-
 //===========================================================================
-aas_routingcache_t *AAS_ReadCache(fileHandle_t fp)
+static int AAS_ReadCache(fileHandle_t fp)
 {
-	int size;
+	int clusterareanum, areacluster;
+	routecacherecord_t record;
 	aas_routingcache_t *cache;
 
-	botimport.FS_Read(&size, sizeof(size), fp);
-	cache = (aas_routingcache_t *) GetMemory(size);
-	cache->size = size;
-	botimport.FS_Read((unsigned char *)cache + sizeof(size), size - sizeof(size), fp);
-	cache->reachabilities = (unsigned char *) cache + sizeof(aas_routingcache_t) - sizeof(unsigned short) +
-		(size - sizeof(aas_routingcache_t) + sizeof(unsigned short)) / 3 * 2;
-	return cache;
+	if (botimport.FS_Read(&record, sizeof(routecacherecord_t), fp) != sizeof(routecacherecord_t)) return qfalse;
+	if (record.areanum <= 0 || record.areanum >= aasworld.numareas) return qfalse;
+	if (record.type == CACHETYPE_AREA)
+	{
+		if (record.cluster <= 0 || record.cluster >= aasworld.numclusters) return qfalse;
+		//the area must be inside the cluster or be one of its portals
+		areacluster = aasworld.areasettings[record.areanum].cluster;
+		if (areacluster < 0)
+		{
+			if (aasworld.portals[-areacluster].frontcluster != record.cluster &&
+					aasworld.portals[-areacluster].backcluster != record.cluster) return qfalse;
+		} //end if
+		else if (areacluster != record.cluster) return qfalse;
+	} //end if
+	else if (record.type != CACHETYPE_PORTAL) return qfalse;
+	if (record.numtraveltimes != AAS_RoutingCacheNumTravelTimes(record.type, record.cluster)) return qfalse;
+	//
+	cache = AAS_AllocRoutingCache(record.numtraveltimes);
+	cache->type = record.type;
+	cache->cluster = record.cluster;
+	cache->areanum = record.areanum;
+	VectorCopy(record.origin, cache->origin);
+	cache->starttraveltime = record.starttraveltime;
+	cache->travelflags = record.travelflags;
+	cache->time = AAS_RoutingTime();
+	botimport.FS_Read(cache->traveltimes, record.numtraveltimes * sizeof(unsigned short int), fp);
+	botimport.FS_Read(cache->reachabilities, record.numtraveltimes * sizeof(unsigned char), fp);
+	//
+	cache->prev = NULL;
+	if (cache->type == CACHETYPE_AREA)
+	{
+		clusterareanum = AAS_ClusterAreaNum(cache->cluster, cache->areanum);
+		cache->next = aasworld.clusterareacache[cache->cluster][clusterareanum];
+		if (cache->next) cache->next->prev = cache;
+		aasworld.clusterareacache[cache->cluster][clusterareanum] = cache;
+	} //end if
+	else
+	{
+		cache->next = aasworld.portalcache[cache->areanum];
+		if (cache->next) cache->next->prev = cache;
+		aasworld.portalcache[cache->areanum] = cache;
+	} //end else
+	AAS_LinkCache(cache);
+	return qtrue;
 } //end of the function AAS_ReadCache
 //===========================================================================
 //
@@ -1056,11 +1111,10 @@ aas_routingcache_t *AAS_ReadCache(fileHandle_t fp)
 //===========================================================================
 int AAS_ReadRouteCache(void)
 {
-	int i, clusterareanum;//, size;
+	int i;
 	fileHandle_t fp;
 	char filename[MAX_QPATH];
 	routecacheheader_t routecacheheader;
-	aas_routingcache_t *cache;
 
 	Com_sprintf(filename, MAX_QPATH, "maps/%s.rcd", aasworld.mapname);
 	botimport.FS_FOpenFile( filename, &fp, FS_READ );
@@ -1071,72 +1125,37 @@ int AAS_ReadRouteCache(void)
 	botimport.FS_Read(&routecacheheader, sizeof(routecacheheader_t), fp );
 	if (routecacheheader.ident != RCID)
 	{
+		botimport.FS_FCloseFile(fp);
 		AAS_Error("%s is not a route cache dump\n", filename);
 		return qfalse;
 	} //end if
-	if (routecacheheader.version != RCVERSION)
-	{
-		AAS_Error("route cache dump has wrong version %d, should be %d", routecacheheader.version, RCVERSION);
-		return qfalse;
-	} //end if
-	if (routecacheheader.numareas != aasworld.numareas)
-	{
-		//AAS_Error("route cache dump has wrong number of areas\n");
-		return qfalse;
-	} //end if
-	if (routecacheheader.numclusters != aasworld.numclusters)
-	{
-		//AAS_Error("route cache dump has wrong number of clusters\n");
-		return qfalse;
-	} //end if
-	if (routecacheheader.areacrc !=
-		CRC_ProcessString( (unsigned char *)aasworld.areas, sizeof(aas_area_t) * aasworld.numareas ))
-	{
-		//AAS_Error("route cache dump area CRC incorrect\n");
+	//a stale dump is simply rebuilt, it's not an error
+	if (routecacheheader.version != RCVERSION ||
+		routecacheheader.numareas != aasworld.numareas ||
+		routecacheheader.numclusters != aasworld.numclusters ||
+		routecacheheader.numportals != aasworld.numportals ||
+		routecacheheader.areacrc !=
+			CRC_ProcessString( (unsigned char *)aasworld.areas, sizeof(aas_area_t) * aasworld.numareas ) ||
+		routecacheheader.clustercrc !=
+			CRC_ProcessString( (unsigned char *)aasworld.clusters, sizeof(aas_cluster_t) * aasworld.numclusters ))
+	{
+		botimport.FS_FCloseFile(fp);
+		botimport.Print(PRT_MESSAGE, "%s is out of date, ignored\n", filename);
 		return qfalse;
 	} //end if
-	if (routecacheheader.clustercrc !=
-		CRC_ProcessString( (unsigned char *)aasworld.clusters, sizeof(aas_cluster_t) * aasworld.numclusters ))
+	//read all the cache, stop when the cache budget is used up
+	for (i = 0; i < routecacheheader.numcaches; i++)
 	{
-		//AAS_Error("route cache dump cluster CRC incorrect\n");
-		return qfalse;
-	} //end if
-	//read all the portal cache
-	for (i = 0; i < routecacheheader.numportalcache; i++)
-	{
-		cache = AAS_ReadCache(fp);
-		cache->next = aasworld.portalcache[cache->areanum];
-		cache->prev = NULL;
-		if (aasworld.portalcache[cache->areanum])
-			aasworld.portalcache[cache->areanum]->prev = cache;
-		aasworld.portalcache[cache->areanum] = cache;
-	} //end for
-	//read all the cluster area cache
-	for (i = 0; i < routecacheheader.numareacache; i++)
-	{
-		cache = AAS_ReadCache(fp);
-		clusterareanum = AAS_ClusterAreaNum(cache->cluster, cache->areanum);
-		cache->next = aasworld.clusterareacache[cache->cluster][clusterareanum];
-		cache->prev = NULL;
-		if (aasworld.clusterareacache[cache->cluster][clusterareanum])
-			aasworld.clusterareacache[cache->cluster][clusterareanum]->prev = cache;
-		aasworld.clusterareacache[cache->cluster][clusterareanum] = cache;
+		if (routingcachesize >= max_routingcachesize) break;
+		if (!AAS_ReadCache(fp))
+		{
+			botimport.Print(PRT_WARNING, "%s: invalid routing cache %d\n", filename, i);
+			break;
+		} //end if
 	} //end for
-	// read the visareas
-	/*
-	aasworld.areavisibility = (byte **) GetClearedMemory(aasworld.numareas * sizeof(byte *));
-	aasworld.decompressedvis = (byte *) GetClearedMemory(aasworld.numareas * sizeof(byte));
-	for (i = 0; i < aasworld.numareas; i++)
-	{
-		botimport.FS_Read(&size, sizeof(size), fp );
-		if (size) {
-			aasworld.areavisibility[i] = (byte *) GetMemory(size);
-			botimport.FS_Read(aasworld.areavisibility[i], size, fp );
-		}
-	}
-	*/
 	//
 	botimport.FS_FCloseFile(fp);
+	botimport.Print(PRT_MESSAGE, "loaded %d routing caches from %s\n", i, filename);
 	return qtrue;
 } //end of the function AAS_ReadRouteCache
 //===========================================================================
@@ -1245,9 +1264,17 @@ void AAS_InitRouting(void)
 #endif //ROUTING_DEBUG
 	//
 	routingcachesize = 0;
-	max_routingcachesize = 1024 * (int) LibVarValue("max_routingcache", "4096");
-	// read any routing cache if available
-	AAS_ReadRouteCache();
+	max_routingcachesize = 1024 * (int) LibVarValue("max_routingcache", "16384");
+	routingcachehits = 0;
+	routingcachemisses = 0;
+	routingcacheevictions = 0;
+	// read any routing cache if available, otherwise build it over the next frames
+	routingprecomputearea = 0;
+	routingprecomputetime = (int) LibVarValue("precomputeroutingtime", "2");
+	if (!AAS_ReadRouteCache() && (int) LibVarValue("precomputeroutingcache", "1"))
+	{
+		routingprecomputearea = 1;
+	} //end if
 } //end of the function AAS_InitRouting
 //===========================================================================
 //
@@ -1432,10 +1459,12 @@ aas_routingcache_t *AAS_GetAreaRoutingCache(int clusternum, int areanum, int tra
 		if (clustercache) clustercache->prev = cache;
 		aasworld.clusterareacache[clusternum][clusterareanum] = cache;
 		AAS_UpdateAreaRoutingCache(cache);
+		routingcachemisses++;
 	} //end if
 	else
 	{
 		AAS_UnlinkCache(cache);
+		routingcachehits++;
 	} //end else
 	//the cache has been accessed
 	cache->time = AAS_RoutingTime();
@@ -1572,10 +1601,12 @@ aas_routingcache_t *AAS_GetPortalRoutingCache(int clusternum, int areanum, int t
 		aasworld.portalcache[areanum] = cache;
 		//update the cache
 		AAS_UpdatePortalRoutingCache(cache);
+		routingcachemisses++;
 	} //end if
 	else
 	{
 		AAS_UnlinkCache(cache);
+		routingcachehits++;
 	} //end else
 	//the cache has been accessed
 	cache->time = AAS_RoutingTime();
@@ -1584,6 +1615,61 @@ aas_routingcache_t *AAS_GetPortalRoutingCache(int clusternum, int areanum, int t
 	return cache;
 } //end of the function AAS_GetPortalRoutingCache
 //===========================================================================
+// incrementally builds the default routing cache towards every area so bots
+// don't have to flood fill the routes the first time they need them,
+// the work is spread over frames to keep the frame time bounded
+//
+// Parameter:			-
+// Returns:				-
+// Changes Globals:		-
+//===========================================================================
+void AAS_ContinuePrecomputeRoutingCache(void)
+{
+	int starttime, areanum, cluster;
+	aas_portal_t *portal;
+
+	if (!aasworld.initialized) return;
+	if (routingprecomputearea <= 0) return;
+	//
+	starttime = Sys_MilliSeconds();
+	for (areanum = routingprecomputearea; areanum < aasworld.numareas; areanum++)
+	{
+		//stop when the time for this frame is used up
+		if (Sys_MilliSeconds() - starttime >= routingprecomputetime) break;
+		//never evict cache to make room for precomputed cache
+		if (routingcachesize >= max_routingcachesize)
+		{
+			areanum = aasworld.numareas;
+			break;
+		} //end if
+		if (!AAS_AreaReachability(areanum)) continue;
+		//
+		cluster = aasworld.areasettings[areanum].cluster;
+		//a portal area is the goal area in both the clusters it connects
+		if (cluster < 0)
+		{
+			portal = &aasworld.portals[-cluster];
+			if (portal->backcluster > 0) AAS_GetAreaRoutingCache(portal->backcluster, areanum, TFL_DEFAULT);
+			cluster = portal->frontcluster;
+		} //end if
+		if (cluster <= 0) continue;
+		AAS_GetAreaRoutingCache(cluster, areanum, TFL_DEFAULT);
+		AAS_GetPortalRoutingCache(cluster, areanum, TFL_DEFAULT);
+	} //end for
+	if (areanum < aasworld.numareas)
+	{
+		routingprecomputearea = areanum;
+		return;
+	} //end if
+	routingprecomputearea = 0;
+	botimport.Print(PRT_MESSAGE, "precomputed %d bytes routing cache\n", routingcachesize);
+	//save the cache so the next time the map is loaded it's read from disk
+	if ((int) LibVarValue("precomputeroutingcache", "1") > 1)
+	{
+		AAS_WriteRouteCache();
+	} //end if
+} //end of the function AAS_ContinuePrecomputeRoutingCache
+//===========================================================================
 //
 // Parameter:			-
 // Returns:				-
@@ -1624,7 +1710,7 @@ int AAS_AreaRouteToGoalArea(int areanum, vec3_t origin, int goalareanum, int tra
 		return qfalse;
 	} //end if
 	// make sure the routing cache doesn't grow to large
-	while(AvailableMemory() < 1 * 1024 * 1024) {
+	while(routingcachesize > max_routingcachesize || AvailableMemory() < 1 * 1024 * 1024) {
 		if (!AAS_FreeOldestCache()) break;
 	}
 	//
@@ -122,3 +122,11 @@ void FX_AdjustTime( int time )
 {
 	theFxHelper.AdjustTime(time);
 }
+
+void FX_ScheduleBench_f( void )
+{
+	const int count = Cmd_Argc() > 1 ? atoi( Cmd_Argv( 1 ) ) : 50000;
+	const int frames = Cmd_Argc() > 2 ? atoi( Cmd_Argv( 2 ) ) : 1000;
+
+	theFxScheduler.ScheduleBenchmark( Q_max( count, 1 ), Q_max( frames, 1 ) );
+}
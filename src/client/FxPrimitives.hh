@@ -154,6 +154,10 @@ public:
 	CEffect();
 	virtual ~CEffect() {}
 
+	// pooled, see FxUtil.cc
+	static void *operator new( size_t size );
+	static void operator delete( void *ptr, size_t size );
+
 	virtual void Die() {}
 	virtual bool Update()	{ return true;		}
 	virtual	void Draw(void) {}
@@ -106,7 +106,7 @@ void CFxScheduler::StopEffect( const char *file, int boltInfo, bool isPortal )
 
 	// Get an extenstion stripped version of the file
 	COM_StripExtension( file, sfile, sizeof( sfile ) );
-	const int id = mEffectIDs[sfile];
+	const int id = FindEffectID( sfile );
 #ifndef FINAL_BUILD
 	if ( id == 0 )
 	{
@@ -190,20 +190,15 @@ SEffectTemplate &SEffectTemplate::operator=(const SEffectTemplate &that)
 void CFxScheduler::Clean(bool bRemoveTemplates /*= true*/, int idToPreserve /*= 0*/)
 {
 	int								i, j;
-	TScheduledEffect::iterator		itr, next;
 
 	// Ditch any scheduled effects
-	itr = mFxSchedule.begin();
-
-	while ( itr != mFxSchedule.end() )
+	for ( i = 0; i < 2; i++ )
 	{
-		next = itr;
-		++next;
-
-		mScheduledEffectsPool.Free (*itr);
-		mFxSchedule.erase(itr);
-
-		itr = next;
+		for ( SScheduledEffect *sfx : mFxSchedule[i] )
+		{
+			mScheduledEffectsPool.Free( sfx );
+		}
+		mFxSchedule[i].clear();
 	}
 
 	if (bRemoveTemplates)
@@ -236,7 +231,7 @@ void CFxScheduler::Clean(bool bRemoveTemplates /*= true*/, int idToPreserve /*=
 		{
 			// Clear the effect names, but first get the name of the effect to preserve,
 			// and restore it after clearing.
-			std::string str;
+			istring str;
 			TEffectID::iterator iter;
 
 			for (iter = mEffectIDs.begin(); iter != mEffectIDs.end(); ++iter)
@@ -286,7 +281,7 @@ int CFxScheduler::RegisterEffect( const char *file, bool bHasCorrectPath /*= fal
 	// see if the specified file is already registered.  If it is, just return the id of that file
 	TEffectID::iterator itr;
 
-	itr = mEffectIDs.find( sfile );
+	itr = mEffectIDs.find( istring_view { sfile } );
 
 	if ( itr != mEffectIDs.end() )
 	{
@@ -533,6 +528,132 @@ SEffectTemplate *CFxScheduler::GetNewEffectTemplate( int *id, const char *file )
 	return 0;
 }
 
+//------------------------------------------------------
+// FindEffectID
+//	Looks up a registered effect without adding the name
+//	to the table when it isn't there.
+//
+// Input:
+//	extension stripped effect name
+//
+// Return:
+//	the effect id, or 0 if the effect isn't registered
+//------------------------------------------------------
+int CFxScheduler::FindEffectID( const char *file ) const
+{
+	TEffectID::const_iterator itr = mEffectIDs.find( istring_view { file } );
+
+	return itr != mEffectIDs.end() ? itr->second : 0;
+}
+
+//------------------------------------------------------
+// ScheduleEffect
+//	Queues a delayed effect for the pass it renders in.
+//
+// Input:
+//	the filled in scheduled effect
+//
+// Return:
+//	none
+//------------------------------------------------------
+void CFxScheduler::ScheduleEffect( SScheduledEffect *sfx )
+{
+	TScheduledEffect &schedule = mFxSchedule[sfx->mPortalEffect ? 1 : 0];
+
+	schedule.push_back( sfx );
+	std::push_heap( schedule.begin(), schedule.end(), SScheduledEffectLater() );
+}
+
+//------------------------------------------------------
+// ScheduleBenchmark
+//	Times the delayed effect schedule against the linear
+//	list walk it replaced.  Due effects are released rather
+//	than created, so only the scheduling cost is measured
+//	and the live schedule is left alone.
+//
+// Input:
+//	count-- how many delayed effects to schedule
+//	frames-- how many 16ms frames to spread them over
+//
+// Return:
+//	none
+//------------------------------------------------------
+void CFxScheduler::ScheduleBenchmark( int count, int frames )
+{
+	const int frameMsec = 16;
+
+	std::vector<SScheduledEffect> effects( count );
+	for ( SScheduledEffect &sfx : effects )
+	{
+		sfx.mStartTime = 1 + rand() % ( frames * frameMsec );
+		sfx.mPortalEffect = ( rand() & 7 ) == 0;
+	}
+
+	// before, one list walked end to end by both the portal and the main pass
+	std::list<SScheduledEffect*> list;
+	int listReleased = 0;
+	int start = Sys_Milliseconds();
+	for ( SScheduledEffect &sfx : effects )
+	{
+		list.push_front( &sfx );
+	}
+	const int listInsert = Sys_Milliseconds() - start;
+
+	start = Sys_Milliseconds();
+	for ( int frame = 1; frame <= frames; frame++ )
+	{
+		const int time = frame * frameMsec;
+		for ( int pass = 0; pass < 2; pass++ )
+		{
+			for ( auto itr = list.begin(); itr != list.end(); )
+			{
+				if ( (*itr)->mPortalEffect == !pass && (*itr)->mStartTime <= time )
+				{
+					itr = list.erase( itr );
+					listReleased++;
+				}
+				else
+				{
+					++itr;
+				}
+			}
+		}
+	}
+	const int listFrames = Sys_Milliseconds() - start;
+
+	// now, one heap per pass that only pops what is due
+	TScheduledEffect heaps[2];
+	int heapReleased = 0;
+	start = Sys_Milliseconds();
+	for ( SScheduledEffect &sfx : effects )
+	{
+		TScheduledEffect &heap = heaps[sfx.mPortalEffect ? 1 : 0];
+		heap.push_back( &sfx );
+		std::push_heap( heap.begin(), heap.end(), SScheduledEffectLater() );
+	}
+	const int heapInsert = Sys_Milliseconds() - start;
+
+	start = Sys_Milliseconds();
+	for ( int frame = 1; frame <= frames; frame++ )
+	{
+		const int time = frame * frameMsec;
+		for ( TScheduledEffect &heap : heaps )
+		{
+			while ( !heap.empty() && heap.front()->mStartTime <= time )
+			{
+				std::pop_heap( heap.begin(), heap.end(), SScheduledEffectLater() );
+				heap.pop_back();
+				heapReleased++;
+			}
+		}
+	}
+	const int heapFrames = Sys_Milliseconds() - start;
+
+	theFxHelper.Print( "%d delayed effects over %d frames\n", count, frames );
+	theFxHelper.Print( "list: %d ms to schedule, %.3f ms per frame, %d released\n", listInsert, (float)listFrames / frames, listReleased );
+	theFxHelper.Print( "heap: %d ms to schedule, %.3f ms per frame, %d released\n", heapInsert, (float)heapFrames / frames, heapReleased );
+}
+
 //------------------------------------------------------
 // GetEffectCopy
 //	Returns a copy of the desired effect so that it can
@@ -548,7 +669,7 @@ SEffectTemplate *CFxScheduler::GetNewEffectTemplate( int *id, const char *file )
 //------------------------------------------------------
 SEffectTemplate *CFxScheduler::GetEffectCopy( const char *file, int *newHandle )
 {
-	return ( GetEffectCopy( mEffectIDs[file], newHandle ) );
+	return ( GetEffectCopy( FindEffectID( file ), newHandle ) );
 }
 
 //------------------------------------------------------
@@ -742,15 +863,17 @@ void CFxScheduler::PlayEffect( const char *file, vec3_t origin, matrix3_t axis,
 	// Get an extenstion stripped version of the file
 	COM_StripExtension( file, sfile, sizeof( sfile ) );
 
+	const int id = FindEffectID( sfile );
+
 #ifndef FINAL_BUILD
-	if ( mEffectIDs[sfile] == 0 )
+	if ( id == 0 )
 	{
 		theFxHelper.Print( "CFxScheduler::PlayEffect unregistered/non-existent effect: %s\n", sfile );
 		return;
 	}
 #endif
 
-	PlayEffect( mEffectIDs[sfile], origin, axis, boltInfo, ghoul2, fxParm, vol, rad, qfalse, iLoopTime, isRelative );
+	PlayEffect( id, origin, axis, boltInfo, ghoul2, fxParm, vol, rad, qfalse, iLoopTime, isRelative );
 }
 
 int	totalPrimitives = 0;
@@ -980,7 +1103,7 @@ void CFxScheduler::PlayEffect( int id, vec3_t origin, matrix3_t axis, const int
 					sfx->mStartTime++;
 				}
 
-				mFxSchedule.push_front( sfx );
+				ScheduleEffect( sfx );
 			}
 		}
 	}
@@ -1035,7 +1158,7 @@ void CFxScheduler::PlayEffect( const char *file, vec3_t origin, vec3_t forward,
 	// Get an extenstion stripped version of the file
 	COM_StripExtension( file, sfile, sizeof( sfile ) );
 
-	PlayEffect( mEffectIDs[sfile], origin, forward, vol, rad );
+	PlayEffect( FindEffectID( sfile ), origin, forward, vol, rad );
 }
 
 //------------------------------------------------------
@@ -1054,7 +1177,6 @@ bool gEffectsInPortal = qfalse; //this is just because I don't want to have to a
 
 void CFxScheduler::AddScheduledEffects( bool portal )
 {
-	TScheduledEffect::iterator	itr, next;
 	vec3_t						origin;
 	matrix3_t					axis;
 	int							oldEntNum = -1, oldBoltIndex = -1, oldModelNum = -1;
@@ -1069,71 +1191,69 @@ void CFxScheduler::AddScheduledEffects( bool portal )
 		AddLoopedEffects();
 	}
 
-	for ( itr = mFxSchedule.begin(); itr != mFxSchedule.end(); /* do nothing */ )
+	//only render portal fx on the skyportal pass and vice versa
+	TScheduledEffect &schedule = mFxSchedule[portal ? 1 : 0];
+
+	while ( !schedule.empty() && schedule.front()->mStartTime <= theFxHelper.mTime )
 	{
-		SScheduledEffect *effect = *itr;
+		SScheduledEffect *effect = schedule.front();
 
-		if (portal == effect->mPortalEffect && effect->mStartTime <= theFxHelper.mTime )
-		{ //only render portal fx on the skyportal pass and vice versa
-			if (effect->mBoltNum == -1)
-			{// ok, are we spawning a bolt on effect or a normal one?
-				if ( effect->mEntNum != ENTITYNUM_NONE )
-				{
-					// Find out where the entity currently is
-					TCGVectorData	*data = (TCGVectorData*)cl.mSharedMemory;
+		std::pop_heap( schedule.begin(), schedule.end(), SScheduledEffectLater() );
+		schedule.pop_back();
 
-					data->mEntityNum = effect->mEntNum;
-					CGVM_GetLerpOrigin();
+		if (effect->mBoltNum == -1)
+		{// ok, are we spawning a bolt on effect or a normal one?
+			if ( effect->mEntNum != ENTITYNUM_NONE )
+			{
+				// Find out where the entity currently is
+				TCGVectorData	*data = (TCGVectorData*)cl.mSharedMemory;
+
+				data->mEntityNum = effect->mEntNum;
+				CGVM_GetLerpOrigin();
+				CreateEffect( effect->mpTemplate,
+							data->mPoint, effect->mAxis,
+							theFxHelper.mTime - effect->mStartTime );
+			}
+			else
+			{
+				CreateEffect( effect->mpTemplate,
+							effect->mOrigin, effect->mAxis,
+							theFxHelper.mTime - effect->mStartTime );
+			}
+		}
+		else
+		{	//bolted on effect
+			// do we need to go and re-get the bolt matrix again? Since it takes time lets try to do it only once
+			if ((effect->mModelNum != oldModelNum) ||
+				(effect->mEntNum != oldEntNum) ||
+				(effect->mBoltNum != oldBoltIndex))
+			{
+				oldModelNum = effect->mModelNum;
+				oldEntNum = effect->mEntNum;
+				oldBoltIndex = effect->mBoltNum;
+
+				doesBoltExist = theFxHelper.GetOriginAxisFromBolt(effect->ghoul2, effect->mEntNum, effect->mModelNum, effect->mBoltNum, origin, axis);
+			}
+
+			// only do this if we found the bolt
+			if (doesBoltExist)
+			{
+				if (effect->mIsRelative )
+				{
 					CreateEffect( effect->mpTemplate,
-								data->mPoint, effect->mAxis,
-								theFxHelper.mTime - effect->mStartTime );
+								origin, axis, 0, -1,
+								effect->ghoul2, effect->mEntNum, effect->mModelNum, effect->mBoltNum );
 				}
 				else
 				{
 					CreateEffect( effect->mpTemplate,
-								effect->mOrigin, effect->mAxis,
+								origin, axis,
 								theFxHelper.mTime - effect->mStartTime );
 				}
 			}
-			else
-			{	//bolted on effect
-				// do we need to go and re-get the bolt matrix again? Since it takes time lets try to do it only once
-				if ((effect->mModelNum != oldModelNum) ||
-					(effect->mEntNum != oldEntNum) ||
-					(effect->mBoltNum != oldBoltIndex))
-				{
-					oldModelNum = effect->mModelNum;
-					oldEntNum = effect->mEntNum;
-					oldBoltIndex = effect->mBoltNum;
-
-					doesBoltExist = theFxHelper.GetOriginAxisFromBolt(effect->ghoul2, effect->mEntNum, effect->mModelNum, effect->mBoltNum, origin, axis);
-				}
-
-				// only do this if we found the bolt
-				if (doesBoltExist)
-				{
-					if (effect->mIsRelative )
-					{
-						CreateEffect( effect->mpTemplate,
-									origin, axis, 0, -1,
-									effect->ghoul2, effect->mEntNum, effect->mModelNum, effect->mBoltNum );
-					}
-					else
-					{
-						CreateEffect( effect->mpTemplate,
-									origin, axis,
-									theFxHelper.mTime - effect->mStartTime );
-					}
-				}
-			}
-
-			mScheduledEffectsPool.Free (effect);
-			itr = mFxSchedule.erase(itr);
-		}
-		else
-		{
-			++itr;
 		}
+
+		mScheduledEffectsPool.Free (effect);
 	}
 
 	// Add all active effects into the scene
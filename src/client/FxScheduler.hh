@@ -25,6 +25,8 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "FxUtil.hh"
 #include "qcommon/GenericParser2.hh"
 
+#include "qcommon/q_string.hh"
+
 #include <algorithm>
 #include <vector>
 #include <map>
@@ -614,9 +616,15 @@ private:
 	};
 
 	// this makes looking up the index based on the string name much easier
-	typedef std::map<std::string, int>				TEffectID;
+	typedef istring_map<int>						TEffectID;
+
+	// min-heap on mStartTime, so only the effects that are due get looked at
+	typedef std::vector<SScheduledEffect*>			TScheduledEffect;
 
-	typedef std::list<SScheduledEffect*>			TScheduledEffect;
+	struct SScheduledEffectLater
+	{
+		bool operator()( const SScheduledEffect *a, const SScheduledEffect *b ) const { return a->mStartTime > b->mStartTime; }
+	};
 
 	// Effects
 	SEffectTemplate		mEffectTemplates[FX_MAX_EFFECTS];
@@ -626,13 +634,16 @@ private:
 	CScheduled2DEffect	m2DEffects[FX_MAX_2DEFFECTS];
 	int					mNextFree2DEffect;
 
-	// List of scheduled effects that will need to be created at the correct time.
-	TScheduledEffect	mFxSchedule;
+	// Scheduled effects that will need to be created at the correct time, one heap for the
+	//	normal view and one for the skyportal pass
+	TScheduledEffect	mFxSchedule[2];
 
 	PagedPoolAllocator<SScheduledEffect, 1024> mScheduledEffectsPool;
 
 	// Private function prototypes
 	SEffectTemplate *GetNewEffectTemplate( int *id, const char *file );
+	int		FindEffectID( const char *file ) const;
+	void	ScheduleEffect( SScheduledEffect *sfx );
 
 	void	AddPrimitiveToEffect( SEffectTemplate *fx, CPrimitiveTemplate *prim );
 	int		ParseEffect( const char *file, CGPGroup *base );
@@ -666,8 +677,9 @@ public:
 	void	Draw2DEffects(float screenXScale, float screenYScale);
 
 	int		GetHighWatermark() const { return mScheduledEffectsPool.GetHighWatermark(); }
-	int		NumScheduledFx()	{ return (int)mFxSchedule.size();	}
+	int		NumScheduledFx()	{ return (int)(mFxSchedule[0].size() + mFxSchedule[1].size());	}
 	void	Clean(bool bRemoveTemplates = true, int idToPreserve = 0);	// clean out the system
+	void	ScheduleBenchmark( int count, int frames );						// fx_schedbench, times the schedule on synthetic effects
 
 	// FX Override functions
 	SEffectTemplate		*GetEffectCopy( int fxHandle, int *newHandle );
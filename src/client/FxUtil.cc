@@ -34,34 +34,110 @@ struct SEffectList
 
 #define PI		3.14159f
 
+// The first activeFx entries are the live effects in the order they were added,
+//	FX_Add compacts out the dead ones so it never has to walk empty slots
 SEffectList		effectList[MAX_EFFECTS];
-SEffectList		*nextValidEffect;
 SFxHelper		theFxHelper;
 
 int				activeFx = 0;
+static int		fxSweepRead = -1, fxSweepWrite = -1;	// FX_Add progress, effects in between have been freed
 int				drawnFx;
 qboolean		fxInitialized = qfalse;
 
 //-------------------------
-// FX_Free
+// CEffect allocation
 //
-// Frees all FX
+// Primitives come and go by the hundreds every frame, so freed ones are kept
+//	on per size free lists and reused instead of going back to the heap
 //-------------------------
-bool FX_Free( bool templates )
+#define FX_POOL_GRANULARITY	64
+#define FX_POOL_BUCKETS		32
+
+struct SFxPoolBlock
+{
+	SFxPoolBlock	*mNext;
+};
+
+static SFxPoolBlock	*fxPool[FX_POOL_BUCKETS];
+
+void *CEffect::operator new( size_t size )
+{
+	const size_t bucket = ( size + FX_POOL_GRANULARITY - 1 ) / FX_POOL_GRANULARITY;
+
+	if ( bucket >= FX_POOL_BUCKETS )
+	{
+		return ::operator new( size );
+	}
+
+	if ( fxPool[bucket] )
+	{
+		SFxPoolBlock *block = fxPool[bucket];
+		fxPool[bucket] = block->mNext;
+		return block;
+	}
+
+	return ::operator new( bucket * FX_POOL_GRANULARITY );
+}
+
+void CEffect::operator delete( void *ptr, size_t size )
+{
+	const size_t bucket = ( size + FX_POOL_GRANULARITY - 1 ) / FX_POOL_GRANULARITY;
+
+	if ( !ptr )
+	{
+		return;
+	}
+
+	if ( bucket >= FX_POOL_BUCKETS )
+	{
+		::operator delete( ptr );
+		return;
+	}
+
+	SFxPoolBlock *block = (SFxPoolBlock *)ptr;
+	block->mNext = fxPool[bucket];
+	fxPool[bucket] = block;
+}
+
+//-------------------------
+// FX_FreePool
+//
+// Hands the pooled primitive memory back to the heap
+//-------------------------
+static void FX_FreePool( void )
 {
-	for ( int i = 0; i < MAX_EFFECTS; i++ )
+	for ( int i = 0; i < FX_POOL_BUCKETS; i++ )
 	{
-		if ( effectList[i].mEffect )
+		while ( fxPool[i] )
 		{
-			delete effectList[i].mEffect;
+			SFxPoolBlock *block = fxPool[i];
+			fxPool[i] = block->mNext;
+			::operator delete( block );
 		}
+	}
+}
 
+//-------------------------
+// FX_Free
+//
+// Frees all FX
+//-------------------------
+bool FX_Free( bool templates )
+{
+	for ( int i = 0; i < activeFx; i++ )
+	{
+		delete effectList[i].mEffect;
 		effectList[i].mEffect = 0;
 	}
 
 	activeFx = 0;
 
 	theFxScheduler.Clean( templates );
+
+	if ( templates )
+	{
+		FX_FreePool();
+	}
 	return true;
 }
 
@@ -72,13 +148,9 @@ bool FX_Free( bool templates )
 //-------------------------
 void FX_Stop( void )
 {
-	for ( int i = 0; i < MAX_EFFECTS; i++ )
+	for ( int i = 0; i < activeFx; i++ )
 	{
-		if ( effectList[i].mEffect )
-		{
-			delete effectList[i].mEffect;
-		}
-
+		delete effectList[i].mEffect;
 		effectList[i].mEffect = 0;
 	}
 
@@ -103,8 +175,8 @@ int	FX_Init( refdef_t* refdef )
 		{
 			effectList[i].mEffect = 0;
 		}
+		activeFx = 0;
 	}
-	nextValidEffect = &effectList[0];
 
 #ifdef _DEBUG
 	fx_freeze = Cvar_Get("fx_freeze", "0", CVAR_CHEAT);
@@ -125,17 +197,27 @@ void FX_SetRefDef(refdef_t *refdef)
 
 //-------------------------
 // FX_FreeMember
+//
+// Removes an effect outside of the FX_Add sweep, later effects move down
+//	one slot so the list stays in the order the effects were added
 //-------------------------
-static void FX_FreeMember( SEffectList *obj )
+static void FX_FreeMember( int index )
 {
-	obj->mEffect->Die();
-	delete obj->mEffect;
-	obj->mEffect = 0;
-
-	// May as well mark this to be used next
-	nextValidEffect = obj;
+	CEffect *effect = effectList[index].mEffect;
 
+	// Unlink first, a death effect may add new primitives
+	memmove( &effectList[index], &effectList[index + 1], ( activeFx - index - 1 ) * sizeof( SEffectList ) );
 	activeFx--;
+	effectList[activeFx].mEffect = 0;
+
+	if ( fxSweepRead > index )
+	{
+		fxSweepRead--;
+		fxSweepWrite--;
+	}
+
+	effect->Die();
+	delete effect;
 }
 
 
@@ -149,77 +231,99 @@ static void FX_FreeMember( SEffectList *obj )
 //-------------------------
 static SEffectList *FX_GetValidEffect()
 {
-	if ( nextValidEffect->mEffect == 0 )
+	while ( activeFx >= MAX_EFFECTS )
 	{
-		return nextValidEffect;
-	}
-
-	int			i;
-	SEffectList	*ef;
-
-	// Blah..plow through the list till we find something that is currently untainted
-	for ( i = 0, ef = effectList; i < MAX_EFFECTS; i++, ef++ )
-	{
-		if ( ef->mEffect == 0 )
+		// FX_Add is part way through compacting the list, close the gap it left
+		//	instead of throwing away a live effect
+		if ( fxSweepRead > fxSweepWrite )
 		{
-			return ef;
+			memmove( &effectList[fxSweepWrite], &effectList[fxSweepRead], ( activeFx - fxSweepRead ) * sizeof( SEffectList ) );
+			for ( int i = activeFx - ( fxSweepRead - fxSweepWrite ); i < activeFx; i++ )
+			{
+				effectList[i].mEffect = 0;
+			}
+			activeFx -= fxSweepRead - fxSweepWrite;
+			fxSweepRead = fxSweepWrite;
+			continue;
 		}
-	}
 
-	// report the error.
+		// report the error.
 #ifndef FINAL_BUILD
-	theFxHelper.Print( "FX system out of effects\n" );
+		theFxHelper.Print( "FX system out of effects\n" );
 #endif
 
-	// Hmmm.. just trashing the first effect in the list is a poor approach
-	FX_FreeMember( &effectList[0] );
+		// Hmmm.. just trashing the oldest effect in the list is a poor approach,
+		//	but never the one FX_Add is updating right now
+		FX_FreeMember( fxSweepRead == 0 ? 1 : 0 );
+	}
 
-	// Recursive call
-	return nextValidEffect;
+	return &effectList[activeFx];
 }
 
 //-------------------------
 // FX_Add
 //
 // Adds all fx to the view
+//
+// Effects are updated in the order they were added.  Survivors are copied
+//	down over the dead ones as the sweep goes, effects spawned during the
+//	sweep are appended and updated in the same pass
 //-------------------------
 void FX_Add( bool portal )
 {
-	int			i;
 	SEffectList	*ef;
 
 	drawnFx = 0;
 
-	int numFx = activeFx;	//but stop when there can't be any more left!
-	for ( i = 0, ef = effectList; i < MAX_EFFECTS && numFx; i++, ef++ )
+	fxSweepRead = fxSweepWrite = 0;
+	while ( fxSweepRead < activeFx )
 	{
-		if ( ef->mEffect != 0)
+		ef = &effectList[fxSweepRead];
+
+		bool dead = false;
+		if (portal != ef->mPortal)
 		{
-			--numFx;
-			if (portal != ef->mPortal)
-			{
-				continue;	//this one does not render in this scene
-			}
-			// Effect is active
-			if ( theFxHelper.mTime > ef->mKillTime )
-			{
-				// Clean up old effects, calling any death effects as needed
-				// this flag just has to be cleared otherwise death effects might not happen correctly
-				ef->mEffect->ClearFlags( FX_KILL_ON_IMPACT );
-				FX_FreeMember( ef );
-			}
-			else
-			{
-				if ( ef->mEffect->Update() == false )
-				{
-					// We've been marked for death
-					FX_FreeMember( ef );
-					continue;
-				}
-			}
+			//this one does not render in this scene
+		}
+		// Effect is active
+		else if ( theFxHelper.mTime > ef->mKillTime )
+		{
+			// Clean up old effects, calling any death effects as needed
+			// this flag just has to be cleared otherwise death effects might not happen correctly
+			ef->mEffect->ClearFlags( FX_KILL_ON_IMPACT );
+			dead = true;
+		}
+		else if ( ef->mEffect->Update() == false )
+		{
+			// We've been marked for death
+			dead = true;
+		}
+
+		// Update may have spawned effects and moved the list, so go by index again
+		ef = &effectList[fxSweepRead];
+		fxSweepRead++;
+
+		if ( dead )
+		{
+			CEffect *effect = ef->mEffect;
+			ef->mEffect = 0;
+
+			effect->Die();
+			delete effect;
+			continue;
 		}
+
+		if ( fxSweepWrite != fxSweepRead - 1 )
+		{
+			effectList[fxSweepWrite] = *ef;
+			ef->mEffect = 0;
+		}
+		fxSweepWrite++;
 	}
 
+	activeFx = fxSweepWrite;
+	fxSweepRead = fxSweepWrite = -1;
+
 
 	if ( fx_debug->integer && !portal)
 	{
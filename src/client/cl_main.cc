@@ -36,6 +36,7 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "cl_uiapi.hh"
 #include "cl_lan.hh"
 #include "snd_local.hh"
+#include "FXExport.hh"
 #include "sys/sys_loadlib.hh"
 
 cvar_t	*cl_renderer;
@@ -2497,6 +2498,7 @@ void CL_InitRef( void ) {
 	ri.PD_Load = PD_Load;
 	
 	ri.Model_LoadObj = Model_LoadObj;
+	ri.GetTaskCore = *[](){ return com_taskcore.get(); };
 	
 	typedef g2export_t *(*G2_GetInterface_f)();
 	G2_GetInterface_f g2gi = (G2_GetInterface_f)Sys_LoadFunction( g2Lib, "G2_GetInterface" );
@@ -2881,6 +2883,7 @@ void CL_Init( void ) {
 	Cmd_AddCommand ("forcepowers", CL_SetForcePowers_f );
 	Cmd_AddCommand ("video", CL_Video_f, "Record demo to avi" );
 	Cmd_AddCommand ("stopvideo", CL_StopVideo_f, "Stop avi recording" );
+	Cmd_AddCommand ("fx_schedbench", FX_ScheduleBench_f, "Time the effect schedule with delayed effects" );
 
 	CL_InitRef();
 
@@ -2955,6 +2958,7 @@ void CL_Shutdown( void ) {
 	Cmd_RemoveCommand ("forcepowers");
 	Cmd_RemoveCommand ("video");
 	Cmd_RemoveCommand ("stopvideo");
+	Cmd_RemoveCommand ("fx_schedbench");
 
 	CL_ShutdownInput();
 	Con_Shutdown();
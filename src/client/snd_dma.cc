@@ -194,6 +194,13 @@ cvar_t		*s_dynamix;
 cvar_t		*s_debugdynamic;
 
 cvar_t		*s_doppler;
+cvar_t		*s_mp3StreamMinKB;
+
+// sfx cache statistics, shown by soundinfo
+static int	s_sfxCacheHits;
+static int	s_sfxCacheMisses;
+static int	s_sfxCacheEvictions;
+static int	s_sfxMP3StreamPlays;
 
 typedef struct
 {
@@ -434,6 +441,11 @@ void S_SoundInfo_f(void) {
 				Com_Printf("No background file.\n" );
 			}
 		}
+
+		const int iLookups = s_sfxCacheHits + s_sfxCacheMisses;
+		Com_Printf("sfx cache: %d hits, %d misses (%.1f%% hit), %d evicted\n",
+					s_sfxCacheHits, s_sfxCacheMisses, iLookups ? 100.0f * s_sfxCacheHits / iLookups : 0.0f, s_sfxCacheEvictions );
+		Com_Printf("%d plays decoded from MP3 while mixing\n", s_sfxMP3StreamPlays );
 	}
 	S_DisplayFreeMemory();
 	Com_Printf("----------------------\n" );
@@ -470,6 +482,7 @@ void S_Init( void ) {
 	s_language = Cvar_Get("s_language","english",CVAR_ARCHIVE | CVAR_NORESTART, "Sound language" );
 
 	s_doppler = Cvar_Get("s_doppler", "1", CVAR_ARCHIVE_ND);
+	s_mp3StreamMinKB = Cvar_Get("s_mp3StreamMinKB", "256", CVAR_ARCHIVE_ND, "Decoded size in KB from which character MP3s stay compressed and are decoded while playing");
 
 	MP3_InitCvars();
 
@@ -1057,6 +1070,27 @@ sfxHandle_t	S_RegisterSound( const char *name)
 	return sfx - s_knownSfx;
 }
 
+/*
+=================
+S_LoadSfxForPlay
+
+Makes sure a sound about to start playing is loaded and keeps the cache stats
+=================
+*/
+static void S_LoadSfxForPlay(sfx_t *sfx)
+{
+	if (sfx->bInMemory == qfalse){
+		s_sfxCacheMisses++;
+		S_memoryLoad(sfx);
+	} else {
+		s_sfxCacheHits++;
+	}
+	if (sfx->eSoundCompressionMethod == ct_MP3) {
+		s_sfxMP3StreamPlays++;
+	}
+	SND_TouchSFX(sfx);
+}
+
 void S_memoryLoad(sfx_t	*sfx)
 {
 	// load the sound file...
@@ -1459,10 +1493,7 @@ void S_StartAmbientSound( const vec3_t origin, int entityNum, unsigned char volu
 		Com_Error( ERR_DROP, "S_StartAmbientSound: handle %i out of range", sfxHandle );
 
 	sfx = &s_knownSfx[ sfxHandle ];
-	if (sfx->bInMemory == qfalse){
-		S_memoryLoad(sfx);
-	}
-	SND_TouchSFX(sfx);
+	S_LoadSfxForPlay(sfx);
 
 #ifdef USE_OPENAL
 	if (s_UseOpenAL)
@@ -1567,10 +1598,7 @@ void S_StartSound(const vec3_t origin, int entityNum, int entchannel, sfxHandle_
 	}
 
 	sfx = &s_knownSfx[ sfxHandle ];
-	if (sfx->bInMemory == qfalse){
-		S_memoryLoad(sfx);
-	}
-	SND_TouchSFX(sfx);
+	S_LoadSfxForPlay(sfx);
 
 	if ( s_show->integer == 1 ) {
 		Com_Printf( "%i : %s on (%d)\n", s_paintedtime, sfx->sSoundName, entityNum );
@@ -2016,7 +2044,8 @@ void S_AddAmbientLoopingSound( const vec3_t origin, unsigned char volume, sfxHan
 	}
 
 	sfx = &s_knownSfx[ sfxHandle ];
-	if (sfx->bInMemory == qfalse){
+	// re-added every frame, so like S_AddLoopingSound it stays out of the cache stats
+	if (sfx->bInMemory == qfalse) {
 		S_memoryLoad(sfx);
 	}
 	SND_TouchSFX(sfx);
@@ -5245,6 +5274,7 @@ int SND_FreeOldestSound(sfx_t *pButNotThisOne /* = NULL */)
 		Com_DPrintf("SND_FreeOldestSound: freeing sound %s\n", sfx->sSoundName);
 
 		iBytesFreed = SND_FreeSFXMem(sfx);
+		s_sfxCacheEvictions++;
 	}
 
 	return iBytesFreed;
@@ -206,6 +206,7 @@ extern cvar_t	*s_testsound;
 extern cvar_t	*s_separation;
 
 extern cvar_t	*s_doppler;
+extern cvar_t	*s_mp3StreamMinKB;
 
 wavinfo_t GetWavinfo (const char *name, byte *wav, int wavlength);
 
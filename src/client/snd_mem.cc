@@ -781,7 +781,10 @@ static qboolean S_LoadSound_Actual( sfx_t *sfx )
 		{
 			int iRawPCMDataSize = MP3_GetUnpackedSize(sLoadName,data,size,qfalse,qfalse);
 
+			// short sounds get decoded once here rather than every time they play
 			if (S_LoadSound_DirIsAllowedToKeepMP3s(sfx->sSoundName)	// NOT sLoadName, this uses original un-languaged name
+				&&
+				iRawPCMDataSize >= s_mp3StreamMinKB->integer * 1024
 				&&
 				MP3Stream_InitFromFile(sfx, data, size, sLoadName, iRawPCMDataSize + 2304 /* + 1 MP3 frame size, jic */,qfalse)
 				)
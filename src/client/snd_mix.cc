@@ -26,6 +26,11 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "client.hh"
 #include "snd_local.hh"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define SND_MIX_SSE2
+	#include <emmintrin.h>
+#endif
+
 portable_samplepair_t paintbuffer[PAINTBUFFER_SIZE];
 int 	*snd_p, snd_linear_count, snd_vol;
 short	*snd_out;
@@ -39,7 +44,18 @@ void S_WriteLinearBlastStereo16 (void)
 	int		i;
 	int		val;
 
-	for (i=0 ; i<snd_linear_count ; i+=2)
+	i = 0;
+#ifdef SND_MIX_SSE2
+	// 4 sample pairs per pass, packssdw saturates exactly like the clamp below
+	for ( ; i+8 <= snd_linear_count ; i+=8)
+	{
+		__m128i lo = _mm_srai_epi32(_mm_loadu_si128((const __m128i *)(snd_p+i)), 8);
+		__m128i hi = _mm_srai_epi32(_mm_loadu_si128((const __m128i *)(snd_p+i+4)), 8);
+		_mm_storeu_si128((__m128i *)(snd_out+i), _mm_packs_epi32(lo, hi));
+	}
+#endif
+
+	for ( ; i<snd_linear_count ; i+=2)
 	{
 		val = snd_p[i]>>8;
 		if (val > 0x7fff)
@@ -271,25 +287,39 @@ CHANNEL MIXING
 static void S_PaintChannelFrom16( channel_t *ch, const sfx_t *sfx, int count, int sampleOffset, int bufferOffset )
 {
 	portable_samplepair_t	*pSamplesDest;
+	const short				*pSamplesSrc;
 	int iData;
-	float ofst = sampleOffset;
 
 	int iLeftVol	= ch->leftvol  * snd_vol;
 	int iRightVol	= ch->rightvol * snd_vol;
 
 	pSamplesDest	= &paintbuffer[ bufferOffset ];
+	pSamplesSrc		= &sfx->pSoundData[ sampleOffset ];
+
+	if (ch->doppler && ch->dopplerScale > 1)
+	{
+		// stepping faster than one sample per output, stop at the end of the data
+		const int iLength = sfx->iSoundLengthInSamples - sampleOffset;
+		float ofst = 0;
 
+		for ( int i=0 ; i<count && (int)ofst < iLength ; i++ )
+		{
+			iData = pSamplesSrc[ (int)ofst ];
+
+			pSamplesDest[i].left  += (iData * iLeftVol )>>8;
+			pSamplesDest[i].right += (iData * iRightVol)>>8;
+			ofst += ch->dopplerScale;
+		}
+		return;
+	}
+
+	// straight 1:1 copy, kept branch free so the compiler can vectorise it
 	for ( int i=0 ; i<count ; i++ )
 	{
-		iData = sfx->pSoundData[ (int)ofst ];
+		iData = pSamplesSrc[ i ];
 
 		pSamplesDest[i].left  += (iData * iLeftVol )>>8;
 		pSamplesDest[i].right += (iData * iRightVol)>>8;
-		if (ch->doppler && ch->dopplerScale > 1) {
-			ofst += 1 * ch->dopplerScale;
-		} else {
-			ofst++;
-		}
 	}
 }
 
@@ -758,7 +758,7 @@ G_ClearLOS
 */
 
 // Position to position
-qboolean G_ClearLOS( gentity_t *self, const vec3_t start, const vec3_t end )
+static qboolean G_ClearLOSTrace( const vec3_t start, const vec3_t end )
 {
 	trace_t		tr;
 	int			traceCount = 0;
@@ -785,6 +785,19 @@ qboolean G_ClearLOS( gentity_t *self, const vec3_t start, const vec3_t end )
 	return qfalse;
 }
 
+qboolean G_ClearLOS( gentity_t *self, const vec3_t start, const vec3_t end )
+{
+	qboolean	visible;
+
+	//the trace ignores nobody, self included, so only the endpoints matter
+	if ( G_VisCacheLookup( start, end, CONTENTS_OPAQUE, &visible ) )
+		return visible;
+
+	visible = G_ClearLOSTrace( start, end );
+	G_VisCacheStore( start, end, CONTENTS_OPAQUE, visible );
+	return visible;
+}
+
 //Entity to position
 qboolean G_ClearLOS2( gentity_t *self, gentity_t *ent, const vec3_t end )
 {
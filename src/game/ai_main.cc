@@ -53,6 +53,9 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "chars.hh"
 #include "inv.hh"
 
+#include <algorithm>
+#include <atomic>
+
 /*
 #define BOT_CTF_DEBUG	1
 */
@@ -63,6 +66,8 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 bot_state_t	*botstates[MAX_CLIENTS];
 //number of bots
 int numbots;
+//incremented every BotAIStartFrame, tags the perception gathered that frame
+static int botPerceiveFrame;
 //floating point time
 float floattime;
 //time to do a regular update
@@ -92,6 +97,7 @@ vmCvar_t bot_debugmessages;
 
 vmCvar_t bot_attachments;
 vmCvar_t bot_camp;
+vmCvar_t bot_parallelPerceive;
 
 vmCvar_t bot_wp_info;
 vmCvar_t bot_wp_edit;
@@ -1013,15 +1019,23 @@ int BotAILoadMap( int restart ) {
 int OrgVisible(vec3_t org1, vec3_t org2, int ignore)
 {
 	trace_t tr;
+	qboolean visible;
+	const qboolean cacheable = (ignore == -1 || ignore == ENTITYNUM_NONE) ? qtrue : qfalse;
+
+	if (cacheable && G_VisCacheLookup(org1, org2, MASK_SOLID, &visible))
+	{
+		return visible;
+	}
 
 	trap->Trace(&tr, org1, NULL, NULL, org2, ignore, MASK_SOLID, qfalse, 0, 0 );
 
-	if (tr.fraction == 1)
+	visible = (tr.fraction == 1) ? qtrue : qfalse;
+	if (cacheable)
 	{
-		return 1;
+		G_VisCacheStore(org1, org2, MASK_SOLID, visible);
 	}
 
-	return 0;
+	return visible;
 }
 
 //special waypoint visibility check
@@ -2154,20 +2168,56 @@ int PassLovedOneCheck(bot_state_t *bs, gentity_t *ent)
 
 qboolean G_ThereIsAMaster(void);
 
+//pvs check against an enemy, answered from this frame's perception when the eye hasn't moved
+static qboolean BotEnemyInPVS(bot_state_t *bs, int ent)
+{
+	if (bs->perceiveFrame == botPerceiveFrame && VectorCompare(bs->perceiveEye, bs->eye))
+	{
+		return (qboolean)bs->perceivePVS[ent];
+	}
+
+	return BotPVSCheck(g_entities[ent].client->ps.origin, bs->eye);
+}
+
+//line of sight from the bot's eye to an enemy, repeats within a frame come from the visibility cache
+static qboolean BotEnemyVisible(bot_state_t *bs, int ent)
+{
+	trace_t tr;
+	qboolean visible;
+	const float *org = g_entities[ent].client->ps.origin;
+
+	if (G_VisCacheLookup(bs->eye, org, MASK_SOLID, &visible))
+	{
+		return visible;
+	}
+
+	trap->Trace(&tr, bs->eye, NULL, NULL, org, -1, MASK_SOLID, qfalse, 0, 0);
+
+	visible = (tr.fraction == 1) ? qtrue : qfalse;
+	G_VisCacheStore(bs->eye, org, MASK_SOLID, visible);
+	return visible;
+}
+
+typedef struct enemyCandidate_s
+{
+	float	dist;
+	int		ent;
+} enemyCandidate_t;
+
 //standard check to find a new enemy.
 int ScanForEnemies(bot_state_t *bs)
 {
 	vec3_t a;
 	float distcheck;
 	float closest;
-	int bestindex;
 	int i;
 	float hasEnemyDist = 0;
 	qboolean noAttackNonJM = qfalse;
+	enemyCandidate_t candidates[MAX_CLIENTS+1];
+	int numCandidates = 0;
 
 	closest = 999999;
 	i = 0;
-	bestindex = -1;
 
 	if (bs->currentEnemy)
 	{ //only switch to a new enemy if he's significantly closer
@@ -2195,52 +2245,71 @@ int ScanForEnemies(bot_state_t *bs)
 		}
 	}
 
+	//gather everyone we could go after, the visibility traces are left for last
 	while (i <= MAX_CLIENTS)
 	{
-		if (i != bs->client && g_entities[i].client && !OnSameTeam(&g_entities[bs->client], &g_entities[i]) && PassStandardEnemyChecks(bs, &g_entities[i]) && BotPVSCheck(g_entities[i].client->ps.origin, bs->eye) && PassLovedOneCheck(bs, &g_entities[i]))
+		if (i != bs->client && g_entities[i].client && !OnSameTeam(&g_entities[bs->client], &g_entities[i]) && PassStandardEnemyChecks(bs, &g_entities[i]) && BotEnemyInPVS(bs, i) && PassLovedOneCheck(bs, &g_entities[i]))
 		{
 			VectorSubtract(g_entities[i].client->ps.origin, bs->eye, a);
 			distcheck = VectorLength(a);
-			vectoangles(a, a);
 
 			if (g_entities[i].client->ps.isJediMaster)
 			{ //make us think the Jedi Master is close so we'll attack him above all
 				distcheck = 1;
 			}
 
-			if (distcheck < closest && ((InFieldOfVision(bs->viewangles, 90, a) && !BotMindTricked(bs->client, i)) || BotCanHear(bs, &g_entities[i], distcheck)) && OrgVisible(bs->eye, g_entities[i].client->ps.origin, -1))
+			if (distcheck < closest &&
+				(!hasEnemyDist || distcheck < (hasEnemyDist - 128)) && //if we have an enemy, only switch to closer if he is 128+ closer to avoid flipping out
+				(!noAttackNonJM || g_entities[i].client->ps.isJediMaster))
 			{
-				if (BotMindTricked(bs->client, i))
-				{
-					if (distcheck < 256 || (level.time - g_entities[i].client->dangerTime) < 100)
-					{
-						if (!hasEnemyDist || distcheck < (hasEnemyDist - 128))
-						{ //if we have an enemy, only switch to closer if he is 128+ closer to avoid flipping out
-							if (!noAttackNonJM || g_entities[i].client->ps.isJediMaster)
-							{
-								closest = distcheck;
-								bestindex = i;
-							}
-						}
-					}
-				}
-				else
-				{
-					if (!hasEnemyDist || distcheck < (hasEnemyDist - 128))
-					{ //if we have an enemy, only switch to closer if he is 128+ closer to avoid flipping out
-						if (!noAttackNonJM || g_entities[i].client->ps.isJediMaster)
-						{
-							closest = distcheck;
-							bestindex = i;
-						}
-					}
-				}
+				candidates[numCandidates].dist = distcheck;
+				candidates[numCandidates].ent = i;
+				numCandidates++;
 			}
 		}
 		i++;
 	}
 
-	return bestindex;
+	//closest first, so the first one we can see is the one we want
+	std::sort(candidates, candidates + numCandidates, [](const enemyCandidate_t &x, const enemyCandidate_t &y) {
+		return x.dist < y.dist || (x.dist == y.dist && x.ent < y.ent);
+	});
+
+	for (i = 0; i < numCandidates; i++)
+	{
+		const int ent = candidates[i].ent;
+
+		distcheck = candidates[i].dist;
+
+		if (BotMindTricked(bs->client, ent))
+		{
+			if (distcheck >= 256 && (level.time - g_entities[ent].client->dangerTime) >= 100)
+			{
+				continue;
+			}
+			if (!BotCanHear(bs, &g_entities[ent], distcheck))
+			{
+				continue;
+			}
+		}
+		else
+		{
+			VectorSubtract(g_entities[ent].client->ps.origin, bs->eye, a);
+			vectoangles(a, a);
+
+			if (!InFieldOfVision(bs->viewangles, 90, a) && !BotCanHear(bs, &g_entities[ent], distcheck))
+			{
+				continue;
+			}
+		}
+
+		if (BotEnemyVisible(bs, ent))
+		{
+			return ent;
+		}
+	}
+
+	return -1;
 }
 
 int WaitingForNow(bot_state_t *bs, vec3_t goalpos)
@@ -7518,6 +7587,40 @@ void StandardBotAI(bot_state_t *bs, float thinktime)
 
 int gUpdateVars = 0;
 
+/*
+==================
+BotPerceive
+
+Read-only part of a bot's think, safe to run for several bots at once:
+pvs checks from the bot's eye to every possible enemy.  trap->InPVS is the only
+import used here.  It only reads the clip map (leaf lookups, cluster pvs, area
+flood numbers), and its one shared write, the c_pointcontents counter, is atomic.
+Portals only change from game code on the main thread, which waits for this pass.
+==================
+*/
+static void BotPerceive(bot_state_t *bs)
+{
+	const gentity_t *self = &g_entities[bs->client];
+	int i;
+
+	if (!self->client)
+	{
+		return;
+	}
+
+	VectorCopy(self->client->ps.origin, bs->perceiveEye);
+	bs->perceiveEye[2] += self->client->ps.viewheight;
+
+	for (i = 0; i <= MAX_CLIENTS; i++)
+	{
+		const gentity_t *ent = &g_entities[i];
+
+		bs->perceivePVS[i] = (i != bs->client && ent->inuse && ent->client) ? BotPVSCheck(ent->client->ps.origin, bs->perceiveEye) : qfalse;
+	}
+
+	bs->perceiveFrame = botPerceiveFrame;
+}
+
 /*
 ==================
 BotAIStartFrame
@@ -7537,6 +7640,7 @@ int BotAIStartFrame(int time) {
 		trap->Cvar_Update(&bot_attachments);
 		trap->Cvar_Update(&bot_forgimmick);
 		trap->Cvar_Update(&bot_honorableduelacceptance);
+		trap->Cvar_Update(&bot_parallelPerceive);
 #ifndef FINAL_BUILD
 		trap->Cvar_Update(&bot_getinthecarrr);
 #endif
@@ -7568,6 +7672,34 @@ int BotAIStartFrame(int time) {
 	if (elapsed_time > BOT_THINK_TIME) thinktime = elapsed_time;
 	else thinktime = BOT_THINK_TIME;
 
+	// perceive in parallel for every bot that thinks this frame, the world doesn't
+	// change until the usercmds are issued below so the results stay valid
+	botPerceiveFrame++;
+	if (bot_parallelPerceive.integer) {
+		int thinking[MAX_CLIENTS];
+		int numThinking = 0;
+
+		for( i = 0; i < MAX_CLIENTS; i++ ) {
+			if( !botstates[i] || !botstates[i]->inuse ) {
+				continue;
+			}
+			if ( botstates[i]->botthink_residual + elapsed_time >= thinktime &&
+				g_entities[i].client->pers.connected == CON_CONNECTED ) {
+				thinking[numThinking++] = i;
+			}
+		}
+
+		if (numThinking > 1) {
+			std::atomic_int next { 0 };
+			trap->GetTaskCore()->enqueue_fill_wait([&]() {
+				int k;
+				while ((k = next++) < numThinking) {
+					BotPerceive(botstates[thinking[k]]);
+				}
+			});
+		}
+	}
+
 	// execute scheduled bot AI
 	for( i = 0; i < MAX_CLIENTS; i++ ) {
 		if( !botstates[i] || !botstates[i]->inuse ) {
@@ -7623,6 +7755,7 @@ int BotAISetup( int restart ) {
 
 	trap->Cvar_Register(&bot_attachments, "bot_attachments", "1", 0);
 	trap->Cvar_Register(&bot_camp, "bot_camp", "1", 0);
+	trap->Cvar_Register(&bot_parallelPerceive, "bot_parallelPerceive", "1", 0);
 
 	trap->Cvar_Register(&bot_wp_info, "bot_wp_info", "1", 0);
 	trap->Cvar_Register(&bot_wp_edit, "bot_wp_edit", "0", CVAR_CHEAT);
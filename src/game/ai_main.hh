@@ -353,6 +353,11 @@ typedef struct bot_state_s
 	int					forceMove_Right;
 	int					forceMove_Up;
 	//end rww
+
+	//world facts gathered in parallel before the serial think, see BotPerceive
+	int					perceiveFrame;					//botPerceiveFrame the data below belongs to
+	vec3_t				perceiveEye;					//eye position the pvs checks were made from
+	byte				perceivePVS[MAX_CLIENTS+1];		//entity is in the pvs of perceiveEye
 } bot_state_t;
 
 void *B_TempAlloc(int size);
@@ -3608,12 +3608,7 @@ void BG_NPCLoadParms( void )
 
 		len = COM_Compress( strbuf.data() );
 		
-		char const * p = strbuf.data();
-		
-		for (char const * token = COM_ParseExt( &p, qtrue ); token[0]; token = COM_ParseExt( &p, qtrue )) {
-			NPCParms[token] = p;
-			SkipBracedSection(&p, 0);
-		}
+		BG_ParseBracedSections( strbuf.data(), NPCParms );
 		
 		trap->FS_Close(f);
 	}
@@ -3641,12 +3636,7 @@ void BG_NPCLoadParms( void )
 
 		len = COM_Compress( strbuf.data() );
 		
-		char const * p = strbuf.data();
-		
-		for (char const * token = COM_ParseExt( &p, qtrue ); token[0]; token = COM_ParseExt( &p, qtrue )) {
-			NPCMetaParms[token] = p;
-			SkipBracedSection(&p, 0);
-		}
+		BG_ParseBracedSections( strbuf.data(), NPCMetaParms );
 		
 		trap->FS_Close(f);
 	}
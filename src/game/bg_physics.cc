@@ -307,9 +307,11 @@ struct bullet_world_t : public physics_world_t {
 			}
 			slick.body->setFriction(0);
 			slick.body->activate(true);
-			
-			parent->world->addRigidBody(solid.body);
-			parent->world->addRigidBody(slick.body);
+		}
+		
+		void link() {
+			solid.parent->world->addRigidBody(solid.body);
+			slick.parent->world->addRigidBody(slick.body);
 		}
 		
 		void set_origin( qm::vec3_t const & origin ) override {
@@ -355,11 +357,19 @@ struct bullet_world_t : public physics_world_t {
 		world_data->world->stepSimulation( time, resolution, 1.0f / resolution );
 	}
 	
-	void add_world( clipMap_t const * map ) override {
+	void set_map( clipMap_t const * map ) override {
 		world_data->map = map;
+	}
+	
+	void build_world() override {
 		worldspawn_object = std::make_unique<world_object_t>( world_data, 0, false );
 	}
 	
+	void link_world() override {
+		if (!worldspawn_object) return;
+		worldspawn_object->link();
+	}
+	
 	void set_gravity( float grav ) override {
 		world_data->world->setGravity({ 0, 0, -grav });
 	}
@@ -450,6 +460,7 @@ struct bullet_world_t : public physics_world_t {
 	
 	physics_object_ptr add_object_bmodel( int submodel_idx ) override {
 		auto object = std::make_shared<world_object_t>(world_data, submodel_idx, true);
+		object->link();
 		objects.insert(object);
 		return object;
 	}
@@ -31,7 +31,12 @@ struct physics_world_t {
 	
 	virtual void advance( float time, int resolution = 120 ) = 0;
 	
-	virtual void add_world( clipMap_t const * map ) = 0;
+	// the world collision is built in two steps so the expensive part can run off the main thread:
+	// build_world only reads the map and creates shapes, link_world adds them to the simulation.
+	// objects may be added and removed between the two
+	virtual void set_map( clipMap_t const * map ) = 0;
+	virtual void build_world() = 0;
+	virtual void link_world() = 0;
 	
 	virtual void set_gravity( float ) = 0;
 	
@@ -1738,6 +1738,7 @@ int		BG_ParseAnimationFile(const char *filename, animation_t *animSet, qboolean
 #ifndef _GAME
 int		BG_ParseAnimationEvtFile( const char *as_filename, int animFileIndex, int eventFileIndex );
 #endif
+void	BG_ParseBracedSections( const char *text, std::unordered_map<istring, std::string> &parms );
 
 qboolean BG_HasAnimation(int animIndex, int animation);
 int		BG_PickAnim( int animIndex, int minAnim, int maxAnim );
@@ -50,6 +50,7 @@ extern stringID_table_t FPTable[];
 
 #define MAX_SABER_DATA_SIZE (1024*1024) // 1mb, was 512kb
 static char saberParms[MAX_SABER_DATA_SIZE];
+static istring_map<const char *> saberParmsIndex; // name -> text following it in saberParms
 
 stringID_table_t saberTable[] = {
 	ENUM2STRING( SABER_NONE ),
@@ -149,6 +150,32 @@ qboolean BG_ParseLiteral( const char **data, const char *string ) {
 	return qfalse;
 }
 
+/*
+=================
+BG_ParseBracedSections
+
+Splits a file of "name { ... }" definitions into parms, storing only the
+braced body of each entry so a later lookup parses just that entry.
+Also used in npc and vehicle code.
+=================
+*/
+void BG_ParseBracedSections( const char *text, std::unordered_map<istring, std::string> &parms ) {
+	const char *p = text;
+
+	for ( const char *token = COM_ParseExt( &p, qtrue ); token[0]; token = COM_ParseExt( &p, qtrue ) ) {
+		istring name = token;
+		const char *start = p;
+
+		SkipBracedSection( &p, 0 );
+		if ( !p ) {
+			// unterminated, let the parser report it when it's used
+			parms[name] = start;
+			break;
+		}
+		parms[name].assign( start, p );
+	}
+}
+
 qboolean BG_ParseLiteralSilent( const char **data, const char *string ) {
 	const char *token;
 
@@ -2010,10 +2037,21 @@ static void WP_SaberSetupKeywordHash( void ) {
 	hashSetup = qtrue;
 }
 
+/*
+=================
+WP_SaberFindParms
+
+Returns the saberParms text following the first definition of saberName
+=================
+*/
+static const char *WP_SaberFindParms( const char *saberName ) {
+	auto iter = saberParmsIndex.find( istring_view { saberName } );
+	return (iter == saberParmsIndex.end()) ? NULL : iter->second;
+}
+
 qboolean WP_SaberParseParms( const char *saberName, saberInfo_t *saber ) {
 	const char	*token, *p;
 	char		useSaber[SABER_NAME_LENGTH];
-	qboolean	triedDefault = qfalse;
 	keywordHash_t *key;
 
 	// make sure the hash table has been setup
@@ -2026,42 +2064,25 @@ qboolean WP_SaberParseParms( const char *saberName, saberInfo_t *saber ) {
 	//Set defaults so that, if it fails, there's at least something there
 	WP_SaberSetDefaults( saber );
 
-	if ( !VALIDSTRING( saberName ) ) {
+	if ( !VALIDSTRING( saberName ) )
 		Q_strncpyz( useSaber, DEFAULT_SABER, sizeof( useSaber ) );
-		triedDefault = qtrue;
-	}
 	else
 		Q_strncpyz( useSaber, saberName, sizeof( useSaber ) );
 
-	//try to parse it out
-	p = saberParms;
-	COM_BeginParseSession( "saberinfo" );
-
 	// look for the right saber
-	while ( p ) {
-		token = COM_ParseExt( &p, qtrue );
-		if ( !token[0] ) {
-			if ( !triedDefault ) {
-				// fall back to default and restart, should always be there
-				p = saberParms;
-				COM_BeginParseSession( "saberinfo" );
-				Q_strncpyz( useSaber, DEFAULT_SABER, sizeof( useSaber ) );
-				triedDefault = qtrue;
-			}
-			else
-				return qfalse;
-		}
-
-		if ( !Q_stricmp( token, useSaber ) )
-			break;
-
-		SkipBracedSection( &p, 0 );
+	p = WP_SaberFindParms( useSaber );
+	if ( !p ) {
+		// fall back to default, should always be there
+		Q_strncpyz( useSaber, DEFAULT_SABER, sizeof( useSaber ) );
+		p = WP_SaberFindParms( useSaber );
 	}
 
 	// even the default saber isn't found?
 	if ( !p )
 		return qfalse;
 
+	COM_BeginParseSession( "saberinfo" );
+
 	// got the name we're using for sure
 	Q_strncpyz( saber->name, useSaber, sizeof( saber->name ) );
 
@@ -2105,30 +2126,13 @@ qboolean WP_SaberParseParm( const char *saberName, const char *parmname, char *s
 		return qfalse;
 	}
 
-	//try to parse it out
-	p = saberParms;
-	COM_BeginParseSession("saberinfo");
-
 	// look for the right saber
-	while ( p )
-	{
-		token = COM_ParseExt( &p, qtrue );
-		if ( token[0] == 0 )
-		{
-			return qfalse;
-		}
-
-		if ( !Q_stricmp( token, saberName ) )
-		{
-			break;
-		}
-
-		SkipBracedSection( &p, 0 );
-	}
+	p = WP_SaberFindParms( saberName );
 	if ( !p )
 	{
 		return qfalse;
 	}
+	COM_BeginParseSession("saberinfo");
 
 	if ( BG_ParseLiteral( &p, "{" ) )
 	{
@@ -2311,6 +2315,15 @@ void WP_SaberLoadParms( void )
 		totallen += len;
 		marker = saberParms+totallen;
 	}
+
+	// index the definitions so lookups don't rescan every loaded .sab
+	saberParmsIndex.clear();
+	const char *p = saberParms;
+	COM_BeginParseSession( "saberindex" );
+	for ( const char *token = COM_ParseExt( &p, qtrue ); token[0]; token = COM_ParseExt( &p, qtrue ) ) {
+		saberParmsIndex.emplace( token, p ); // first definition wins, as with the old linear search
+		SkipBracedSection( &p, 0 );
+	}
 }
 
 #ifdef UI_BUILD
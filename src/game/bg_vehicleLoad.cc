@@ -1276,12 +1276,7 @@ void BG_VehWeaponLoadParms( void )
 		
 		//len = COM_Compress( strbuf.data() );
 		
-		char const * p = strbuf.data();
-		
-		for (char const * token = COM_ParseExt( &p, qtrue ); token[0]; token = COM_ParseExt( &p, qtrue )) {
-			VehWeaponParms[token] = p;
-			SkipBracedSection(&p, 0);
-		}
+		BG_ParseBracedSections( strbuf.data(), VehWeaponParms );
 		
 		trap->FS_Close( f );
 	}
@@ -1321,12 +1316,7 @@ void BG_VehicleLoadParms( void )
 		
 		//len = COM_Compress( strbuf.data() );
 		
-		char const * p = strbuf.data();
-		
-		for (char const * token = COM_ParseExt( &p, qtrue ); token[0]; token = COM_ParseExt( &p, qtrue )) {
-			VehicleParms[token] = p;
-			SkipBracedSection(&p, 0);
-		}
+		BG_ParseBracedSections( strbuf.data(), VehicleParms );
 
 		trap->FS_Close( f );
 	}
@@ -60,32 +60,56 @@ static const cvarTable_t gameCvarTable[] = {
 };
 static const size_t gameCvarTableSize = ARRAY_LEN( gameCvarTable );
 
+static std::unordered_map<cvarHandle_t, const cvarTable_t *> gameCvarHandles;
+static int gameCvarChangeSequence = -1;
+
 void G_RegisterCvars( void ) {
 	size_t i = 0;
 	const cvarTable_t *cv = NULL;
 
+	gameCvarHandles.clear();
+	gameCvarChangeSequence = -1;
+
 	for ( i=0, cv=gameCvarTable; i<gameCvarTableSize; i++, cv++ ) {
 		trap->Cvar_Register( cv->vmCvar, cv->cvarName, cv->defaultString, cv->cvarFlags );
+		if ( cv->vmCvar )
+			gameCvarHandles[cv->vmCvar->handle] = cv;
+		if ( cv->update )
+			cv->update();
+	}
+}
+
+static void G_UpdateCvar( const cvarTable_t *cv ) {
+	int modCount = cv->vmCvar->modificationCount;
+	trap->Cvar_Update( cv->vmCvar );
+	if ( cv->vmCvar->modificationCount != modCount ) {
 		if ( cv->update )
 			cv->update();
+
+		if ( cv->trackChange )
+			trap->SendServerCommand( -1, va("print \"Server: %s changed to %s\n\"", cv->cvarName, cv->vmCvar->string ) );
 	}
 }
 
 void G_UpdateCvars( void ) {
-	size_t i = 0;
-	const cvarTable_t *cv = NULL;
+	cvarHandle_t changed[64];
+	int numChanged = trap->Cvar_ChangeFeed( &gameCvarChangeSequence, changed, ARRAY_LEN( changed ) );
 
-	for ( i=0, cv=gameCvarTable; i<gameCvarTableSize; i++, cv++ ) {
-		if ( cv->vmCvar ) {
-			int modCount = cv->vmCvar->modificationCount;
-			trap->Cvar_Update( cv->vmCvar );
-			if ( cv->vmCvar->modificationCount != modCount ) {
-				if ( cv->update )
-					cv->update();
-
-				if ( cv->trackChange )
-					trap->SendServerCommand( -1, va("print \"Server: %s changed to %s\n\"", cv->cvarName, cv->vmCvar->string ) );
-			}
+	if ( numChanged < 0 ) {
+		// first frame or too much changed at once, poll them all
+		size_t i = 0;
+		const cvarTable_t *cv = NULL;
+
+		for ( i=0, cv=gameCvarTable; i<gameCvarTableSize; i++, cv++ ) {
+			if ( cv->vmCvar )
+				G_UpdateCvar( cv );
 		}
+		return;
+	}
+
+	for ( int i=0; i<numChanged; i++ ) {
+		auto iter = gameCvarHandles.find( changed[i] );
+		if ( iter != gameCvarHandles.end() )
+			G_UpdateCvar( iter->second );
 	}
 }
@@ -149,7 +149,7 @@ bool gentity_t::add_obj_physics( char const * model_name, qm::vec3_t const & pos
 }
 
 bool gentity_t::add_bmodel_physics() {
-	if (!model || model[0] != '*') return false;
+	if (!g_phys || !model || model[0] != '*') return false;
 	auto subm = std::strtol(model + 1, nullptr, 10);
 	auto object = g_phys->add_object_bmodel(subm);
 	auto physics = set_component<GEntPhysics>();
@@ -0,0 +1,213 @@
+/*
+===========================================================================
+Copyright (C) 2013 - 2015, OpenJK contributors
+
+This file is part of the OpenJK source code.
+
+OpenJK is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License version 2 as
+published by the Free Software Foundation.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, see <http://www.gnu.org/licenses/>.
+===========================================================================
+*/
+
+// g_load.c -- map load pipeline
+//
+// G_InitGame is split into timed stages with explicit dependencies.  Worker
+// stages must not touch the game imports (file system, zone, cvars, console),
+// so they only read the clip map and their own data; they start on the task
+// core as soon as the stages they depend on are done.  Main thread stages run
+// immediately, in the order they are added, after waiting for their
+// dependencies.  G_LoadFinish drains the graph and prints the timings.
+//
+// A stage's future exists before its work runs and always ends up holding either
+// completion or the exception the work threw.  Waiting on a stage that failed
+// raises ERR_DROP on the main thread, so nothing builds on a half done stage.
+
+#include "g_local.hh"
+
+#include <chrono>
+#include <deque>
+#include <exception>
+
+using loadClock_t = std::chrono::steady_clock;
+
+typedef struct loadStage_s {
+	const char					*name;
+	qboolean					worker;
+	std::shared_future<void>	done;
+	loadClock_t::time_point		start, end;
+} loadStage_t;
+
+static std::deque<loadStage_t>	loadStages;	// appending keeps references to earlier stages valid
+static loadClock_t::time_point	loadStart;
+
+static int G_LoadAdd( const char *name, qboolean worker ) {
+	if ( loadStages.empty() ) {
+		loadStart = loadClock_t::now();
+	}
+	loadStage_t &stage = loadStages.emplace_back();
+	stage.name = name;
+	stage.worker = worker;
+	return (int)loadStages.size() - 1;
+}
+
+/*
+================
+G_LoadStage
+
+Queues work that only reads shared load data on the task core, returns the stage handle
+================
+*/
+int G_LoadStage( const char *name, std::function<void()> work, std::initializer_list<int> deps ) {
+	const int index = G_LoadAdd( name, qtrue );
+
+	std::vector<std::shared_future<void>> waits;
+	for ( int dep : deps ) {
+		assert( dep >= 0 && dep < index );
+		waits.emplace_back( loadStages[dep].done );
+	}
+
+	loadStage_t *self = &loadStages[index];
+	auto finished = std::make_shared<std::promise<void>>();
+	self->done = finished->get_future().share();
+
+	// nothing may escape onto the task core, a failure is handed to whoever waits on the stage
+	auto run = [self, finished, work = std::move( work ), waits = std::move( waits )]() {
+		try {
+			for ( const std::shared_future<void> &wait : waits ) {
+				wait.get();
+			}
+			self->start = loadClock_t::now();
+			work();
+			self->end = loadClock_t::now();
+			finished->set_value();
+		}
+		catch ( ... ) {
+			finished->set_exception( std::current_exception() );
+		}
+	};
+
+	if ( g_loadParallel.integer ) {
+		trap->GetTaskCore()->enqueue( std::move( run ) );
+	}
+	else {
+		run();
+	}
+	return index;
+}
+
+/*
+================
+G_LoadMain
+
+Runs work on the main thread now, once the stages it depends on are done
+================
+*/
+int G_LoadMain( const char *name, std::function<void()> work, std::initializer_list<int> deps ) {
+	for ( int dep : deps ) {
+		G_LoadWait( dep );
+	}
+
+	const int index = G_LoadAdd( name, qfalse );
+	std::promise<void> finished;
+	loadStages[index].done = finished.get_future().share();
+
+	loadStages[index].start = loadClock_t::now();
+	try {
+		work();
+	}
+	catch ( ... ) {
+		// usually an ERR_DROP, G_ShutdownGame still finds a finished stage
+		finished.set_exception( std::current_exception() );
+		throw;
+	}
+	loadStages[index].end = loadClock_t::now();
+
+	finished.set_value();
+	return index;
+}
+
+/*
+================
+G_LoadCheck
+
+Waits for the stage and turns a failure into an ERR_DROP
+================
+*/
+static void G_LoadCheck( const loadStage_t &stage ) {
+	if ( !stage.done.valid() ) {
+		return;
+	}
+
+	try {
+		stage.done.get();
+	}
+	catch ( const std::exception &e ) {
+		trap->Error( ERR_DROP, "Load stage \"%s\" failed: %s", stage.name, e.what() );
+	}
+	catch ( ... ) {
+		trap->Error( ERR_DROP, "Load stage \"%s\" failed", stage.name );
+	}
+}
+
+void G_LoadWait( int stage ) {
+	if ( stage < 0 || stage >= (int)loadStages.size() ) {
+		return;
+	}
+	G_LoadCheck( loadStages[stage] );
+}
+
+static int G_LoadMsec( loadClock_t::time_point a, loadClock_t::time_point b ) {
+	return (int)std::chrono::duration_cast<std::chrono::milliseconds>( b - a ).count();
+}
+
+/*
+================
+G_LoadFinish
+
+Waits for every outstanding stage and, if asked, prints when each one ran relative to the first.
+Also used on shutdown, so a load aborted by an error never leaves a worker running; that
+path only waits and never throws, whatever the stages ended with.
+================
+*/
+void G_LoadFinish( qboolean report ) {
+	if ( loadStages.empty() ) {
+		return;
+	}
+
+	if ( !report ) {
+		for ( const loadStage_t &stage : loadStages ) {
+			if ( stage.done.valid() ) {
+				stage.done.wait();
+			}
+		}
+		loadStages.clear();
+		return;
+	}
+
+	// a worker stage nothing waited on may still have failed
+	for ( const loadStage_t &stage : loadStages ) {
+		G_LoadCheck( stage );
+	}
+	const loadClock_t::time_point end = loadClock_t::now();
+
+	int busy = 0;
+	trap->Print( "------- Map Load Stages -------\n" );
+	for ( const loadStage_t &stage : loadStages ) {
+		const int msec = G_LoadMsec( stage.start, stage.end );
+		busy += msec;
+		trap->Print( "%-16s %6d ms  (%6d - %6d)%s\n", stage.name, msec,
+			G_LoadMsec( loadStart, stage.start ), G_LoadMsec( loadStart, stage.end ), stage.worker ? "  worker" : "" );
+	}
+	trap->Print( "%d ms total, %d ms of stage work\n", G_LoadMsec( loadStart, end ), busy );
+
+	loadStages.clear();
+}
@@ -1396,6 +1396,14 @@ void *G_Alloc( int size );
 void G_InitMemory( void );
 void Svcmd_GameMem_f( void );
 
+//
+// g_vis.c
+//
+qboolean G_VisCacheLookup( const vec3_t start, const vec3_t end, int mask, qboolean *visible );
+void G_VisCacheStore( const vec3_t start, const vec3_t end, int mask, qboolean visible );
+void Svcmd_LOSStats_f( void );
+void Svcmd_SaberStats_f( void );
+
 //
 // g_session.cc
 //
@@ -1552,7 +1560,8 @@ void G_RegisterCvars( void );
 void G_UpdateCvars( void );
 
 // g_physics.cc
-void G_Physics_Init();
+int G_Physics_Init();
+void G_Physics_Link( int worldStage );
 void G_Physics_Shutdown();
 
 void G_Physics_Frame( int time );
@@ -1606,5 +1615,11 @@ void G_Task_Shutdown();
 void G_Task_Run();
 void G_Task_Enqueue(GTaskType &&);
 
+// g_load.cc
+int G_LoadStage( const char *name, std::function<void()> work, std::initializer_list<int> deps = {} );
+int G_LoadMain( const char *name, std::function<void()> work, std::initializer_list<int> deps = {} );
+void G_LoadWait( int stage );
+void G_LoadFinish( qboolean report );
+
 // trap
 extern gameImport_t *trap;
@@ -254,7 +254,8 @@ void G_InitGame( int levelTime, int randomSeed, int restart ) {
 		trap->Print( "Not logging security events to disk.\n" );
 
 	G_Task_Init();
-	if (g_physics.integer) G_Physics_Init();
+	int physicsWorld = -1;
+	if (g_physics.integer) physicsWorld = G_Physics_Init();
 
 	G_LogWeaponInit();
 
@@ -318,36 +319,40 @@ void G_InitGame( int levelTime, int randomSeed, int restart ) {
 	G_CacheMapname( &mapname );
 	trap->Cvar_Register( &ckSum, "sv_mapChecksum", "", CVAR_ROM );
 
-	navCalculatePaths	= ( trap->Nav_Load( mapname.string, ckSum.integer ) == qfalse );
+	G_LoadMain( "nav", [&]() {
+		navCalculatePaths	= ( trap->Nav_Load( mapname.string, ckSum.integer ) == qfalse );
+	});
 
-	// parse the key/value pairs and spawn gentities
-	G_SpawnEntitiesFromString(qfalse);
+	G_LoadMain( "entities", [&]() {
+		// parse the key/value pairs and spawn gentities
+		G_SpawnEntitiesFromString(qfalse);
 
-	// general initialization
-	G_FindTeams();
+		// general initialization
+		G_FindTeams();
 
-	// make sure we have flags for CTF, etc
-	if( level.gametype >= GT_TEAM ) {
-		G_CheckTeamItems();
-	}
-	else if ( level.gametype == GT_JEDIMASTER )
-	{
-		trap->SetConfigstring ( CS_CLIENT_JEDIMASTER, "-1" );
-	}
+		// make sure we have flags for CTF, etc
+		if( level.gametype >= GT_TEAM ) {
+			G_CheckTeamItems();
+		}
+		else if ( level.gametype == GT_JEDIMASTER )
+		{
+			trap->SetConfigstring ( CS_CLIENT_JEDIMASTER, "-1" );
+		}
 
-	if (level.gametype == GT_POWERDUEL)
-	{
-		trap->SetConfigstring ( CS_CLIENT_DUELISTS, va("-1|-1|-1") );
-	}
-	else
-	{
-		trap->SetConfigstring ( CS_CLIENT_DUELISTS, va("-1|-1") );
-	}
-// nmckenzie: DUEL_HEALTH: Default.
-	trap->SetConfigstring ( CS_CLIENT_DUELHEALTHS, va("-1|-1|!") );
-	trap->SetConfigstring ( CS_CLIENT_DUELWINNER, va("-1") );
+		if (level.gametype == GT_POWERDUEL)
+		{
+			trap->SetConfigstring ( CS_CLIENT_DUELISTS, va("-1|-1|-1") );
+		}
+		else
+		{
+			trap->SetConfigstring ( CS_CLIENT_DUELISTS, va("-1|-1") );
+		}
+	// nmckenzie: DUEL_HEALTH: Default.
+		trap->SetConfigstring ( CS_CLIENT_DUELHEALTHS, va("-1|-1|!") );
+		trap->SetConfigstring ( CS_CLIENT_DUELWINNER, va("-1") );
 
-	SaveRegisteredItems();
+		SaveRegisteredItems();
+	});
 
 	//trap->Print ("-----------------------------------\n");
 
@@ -357,13 +362,17 @@ void G_InitGame( int levelTime, int randomSeed, int restart ) {
 		G_SoundIndex( "sound/player/gurp2.wav" );
 	}
 
-	if ( trap->Cvar_VariableIntegerValue( "bot_enable" ) ) {
-		BotAISetup( restart );
-		BotAILoadMap( restart );
-		G_InitBots( );
-	} else {
-		G_LoadArenas();
-	}
+	// botlib AAS and waypoint loading go through the file system and zone
+	// allocator, so they share the main thread with everything else
+	G_LoadMain( "bots", [&]() {
+		if ( trap->Cvar_VariableIntegerValue( "bot_enable" ) ) {
+			BotAISetup( restart );
+			BotAILoadMap( restart );
+			G_InitBots( );
+		} else {
+			G_LoadArenas();
+		}
+	});
 
 	if ( level.gametype == GT_DUEL || level.gametype == GT_POWERDUEL )
 	{
@@ -431,6 +440,11 @@ void G_InitGame( int levelTime, int randomSeed, int restart ) {
 	}
 	
 	g_loc_man = std::make_unique<LocationManager>();
+
+	if ( physicsWorld >= 0 ) {
+		G_Physics_Link( physicsWorld );
+	}
+	G_LoadFinish( qtrue );
 }
 
 
@@ -519,6 +533,7 @@ void G_ShutdownGame( int restart ) {
 		BotAIShutdown( restart );
 	}
 	
+	G_LoadFinish( qfalse );
 	G_Physics_Shutdown();
 	G_Task_Shutdown();
 	
@@ -3,7 +3,8 @@
 
 std::unique_ptr<physics_world_t> g_phys;
 
-void G_Physics_Init() {
+// the world collision builds on a worker while entities spawn, returns that load stage
+int G_Physics_Init() {
 	
 	Com_Printf("================================================\n");
 	Com_Printf("INITIALIZING SERVERSIDE PHYSICS\n");
@@ -13,7 +14,12 @@ void G_Physics_Init() {
 	g_phys->set_gravity(g_gravity.value);
 	
 	clipMap_t const * cm = reinterpret_cast<clipMap_t const *>(trap->CM_Get());
-	g_phys->add_world(cm);
+	g_phys->set_map(cm);
+	return G_LoadStage("physics world", [](){ g_phys->build_world(); });
+}
+
+void G_Physics_Link( int worldStage ) {
+	G_LoadMain("physics link", [](){ g_phys->link_world(); }, { worldStage });
 	Com_Printf("DONE\n================================================\n");
 }
 
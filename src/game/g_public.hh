@@ -32,7 +32,7 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 
 #define Q3_INFINITE			16777216
 
-#define	GAME_API_VERSION	1
+#define	GAME_API_VERSION	2
 
 // entity->svFlags
 // the server does not know how to interpret most of the values
@@ -1100,6 +1100,12 @@ typedef struct gameImport_s {
 	void		(*G2API_GetSurfaceName)					( void *ghoul2, int surfNumber, int modelIndex, char *fillBuf );
 	
 	objModel_t * 	(*Model_LoadObj)					( char const * name);
+
+	// cvar change feed, see Cvar_ChangeFeed
+	int			(*Cvar_ChangeFeed)						( int *sequence, cvarHandle_t *handles, int maxHandles );
+
+	// Trace without entity clipping, see SV_TraceWorld
+	void		(*TraceWorld)							( trace_t *results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int contentmask, int capsule );
 } gameImport_t;
 
 typedef struct gameExport_s {
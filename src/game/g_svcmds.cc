@@ -489,7 +489,9 @@ svcmd_t svcmds[] = {
 	{ "forceteam",					Svcmd_ForceTeam_f,					qfalse },
 	{ "game_memory",				Svcmd_GameMem_f,					qfalse },
 	{ "listip",						Svcmd_ListIP_f,						qfalse },
+	{ "losstats",					Svcmd_LOSStats_f,					qfalse },
 	{ "removeip",					Svcmd_RemoveIP_f,					qfalse },
+	{ "saberstats",					Svcmd_SaberStats_f,					qfalse },
 	{ "say",						Svcmd_Say_f,						qtrue },
 	{ "toggleallowvote",			Svcmd_ToggleAllowVote_f,			qfalse },
 	{ "toggleuserinfovalidation",	Svcmd_ToggleUserinfoValidation_f,	qfalse },
@@ -0,0 +1,133 @@
+/*
+===========================================================================
+Copyright (C) 2013 - 2015, OpenJK contributors
+
+This file is part of the OpenJK source code.
+
+OpenJK is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License version 2 as
+published by the Free Software Foundation.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, see <http://www.gnu.org/licenses/>.
+===========================================================================
+*/
+
+// g_vis.c -- per frame line of sight cache
+//
+// Bot enemy scans (BotEnemyVisible, OrgVisible) and NPC senses (G_ClearLOS
+// and its variants) repeat the same visibility traces many times a frame.
+// None of those traces skips an entity, so the answer only depends on the
+// exact start and end points and the content mask, and that is the whole key.
+// Only a repeat of the same trace in the same direction is answered; the
+// reverse trace is not assumed to agree.  Entries are tagged with
+// level.framenum so everything is invalidated simply by starting a new frame.
+
+#include "g_local.hh"
+
+#define VIS_CACHE_SIZE	4096	// power of two
+
+typedef struct visCacheEntry_s {
+	int			framenum;
+	int			mask;
+	vec3_t		start, end;
+	qboolean	visible;
+} visCacheEntry_t;
+
+static visCacheEntry_t	visCache[VIS_CACHE_SIZE];
+
+static struct {
+	int		framenum;
+	int		frameHits, frameTraces;
+	int		lastHits, lastTraces;
+	int64_t	totalHits, totalTraces;
+} visStats;
+
+static void G_VisRollStats( void ) {
+	if ( visStats.framenum == level.framenum ) {
+		return;
+	}
+	visStats.lastHits = visStats.frameHits;
+	visStats.lastTraces = visStats.frameTraces;
+	visStats.frameHits = visStats.frameTraces = 0;
+	visStats.framenum = level.framenum;
+}
+
+/*
+================
+G_VisCacheSlot
+
+Returns the slot the trace hashes to
+================
+*/
+static visCacheEntry_t *G_VisCacheSlot( const vec3_t start, const vec3_t end, int mask ) {
+	uint32_t hash = 2166136261u;
+	const int key[7] = { mask, (int)start[0], (int)start[1], (int)start[2], (int)end[0], (int)end[1], (int)end[2] };
+	for ( int v : key ) {
+		hash = ( hash ^ (uint32_t)v ) * 16777619u;
+	}
+	return &visCache[hash & ( VIS_CACHE_SIZE - 1 )];
+}
+
+/*
+================
+G_VisCacheLookup
+
+Returns qtrue and fills in visible when this frame already traced start to end with mask
+================
+*/
+qboolean G_VisCacheLookup( const vec3_t start, const vec3_t end, int mask, qboolean *visible ) {
+	if ( !g_losCache.integer ) {
+		return qfalse;
+	}
+
+	G_VisRollStats();
+
+	const visCacheEntry_t *entry = G_VisCacheSlot( start, end, mask );
+	if ( entry->framenum != level.framenum || entry->mask != mask
+		|| !VectorCompare( entry->start, start ) || !VectorCompare( entry->end, end ) ) {
+		visStats.frameTraces++;
+		visStats.totalTraces++;
+		return qfalse;
+	}
+
+	visStats.frameHits++;
+	visStats.totalHits++;
+	*visible = entry->visible;
+	return qtrue;
+}
+
+void G_VisCacheStore( const vec3_t start, const vec3_t end, int mask, qboolean visible ) {
+	if ( !g_losCache.integer ) {
+		return;
+	}
+
+	visCacheEntry_t *entry = G_VisCacheSlot( start, end, mask );
+	entry->framenum = level.framenum;
+	entry->mask = mask;
+	VectorCopy( start, entry->start );
+	VectorCopy( end, entry->end );
+	entry->visible = visible;
+}
+
+void Svcmd_LOSStats_f( void ) {
+	if ( trap->Argc() > 1 ) {
+		char arg[MAX_TOKEN_CHARS];
+		trap->Argv( 1, arg, sizeof( arg ) );
+		if ( !Q_stricmp( arg, "reset" ) ) {
+			memset( &visStats, 0, sizeof( visStats ) );
+			return;
+		}
+	}
+
+	G_VisRollStats();
+	trap->Print( "line of sight cache %s\n", g_losCache.integer ? "enabled" : "disabled" );
+	trap->Print( "last frame: %d hits, %d unique traces\n", visStats.lastHits, visStats.lastTraces );
+	trap->Print( "total: %lld hits, %lld unique traces (%.1f%% saved)\n", (long long)visStats.totalHits, (long long)visStats.totalTraces,
+		visStats.totalHits + visStats.totalTraces ? 100.0 * visStats.totalHits / ( visStats.totalHits + visStats.totalTraces ) : 0.0 );
+}
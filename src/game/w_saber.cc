@@ -2816,6 +2816,35 @@ FIXME: test the intersection to see if the sabers really did intersect (weren't
 */
 extern qboolean tri_tri_intersect(vec3_t V0,vec3_t V1,vec3_t V2,vec3_t U0,vec3_t U1,vec3_t U2);
 #define SABER_EXTRAPOLATE_DIST 16.0f
+
+static qboolean G_SaberSweepsOverlap( const vec3_t base1, const vec3_t tip1, const vec3_t baseNext1, const vec3_t tipNext1,
+	const vec3_t base2, const vec3_t tip2, const vec3_t baseNext2, const vec3_t tipNext2 )
+{
+	vec3_t mins1, maxs1, mins2, maxs2;
+	int i;
+
+	ClearBounds( mins1, maxs1 );
+	AddPointToBounds( base1, mins1, maxs1 );
+	AddPointToBounds( tip1, mins1, maxs1 );
+	AddPointToBounds( baseNext1, mins1, maxs1 );
+	AddPointToBounds( tipNext1, mins1, maxs1 );
+
+	ClearBounds( mins2, maxs2 );
+	AddPointToBounds( base2, mins2, maxs2 );
+	AddPointToBounds( tip2, mins2, maxs2 );
+	AddPointToBounds( baseNext2, mins2, maxs2 );
+	AddPointToBounds( tipNext2, mins2, maxs2 );
+
+	for ( i = 0; i < 3; i++ )
+	{
+		if ( mins1[i] > maxs2[i] || mins2[i] > maxs1[i] )
+		{
+			return qfalse;
+		}
+	}
+	return qtrue;
+}
+
 qboolean WP_SabersIntersect( gentity_t *ent1, int ent1SaberNum, int ent1BladeNum, gentity_t *ent2, qboolean checkDir )
 {
 	vec3_t	saberBase1, saberTip1, saberBaseNext1, saberTipNext1;
@@ -2917,6 +2946,11 @@ qboolean WP_SabersIntersect( gentity_t *ent1, int ent1SaberNum, int ent1BladeNum
 						}
 					}
 
+					if ( !G_SaberSweepsOverlap( saberBase1, saberTip1, saberBaseNext1, saberTipNext1, saberBase2, saberTip2, saberBaseNext2, saberTipNext2 ) )
+					{//the swept blades are nowhere near each other, none of the tris can intersect
+						continue;
+					}
+
 #ifdef DEBUG_SABER_BOX
 					if ( g_saberDebugBox.integer == 2 || g_saberDebugBox.integer == 4 )
 					{
@@ -3821,6 +3855,234 @@ static float saberHitFraction = 1.0f;
 //This is a large function. I feel sort of bad inlining it. But it does get called tons of times per frame.
 qboolean BG_SuperBreakWinAnim( int anim );
 
+/*
+=============================================================================
+
+SABER SWEEP BROADPHASE
+
+G_SPSaberDamageTraceLerped breaks every swing into dozens of damage traces.
+Before the swing is traced, its swept volume is bounded: the base moves along
+the segment from its old to its new position while the blade direction turns
+through the pitch and yaw range LerpAngle interpolates, so every blade point
+the damage traces start or end at lies inside base bounds + blade length times
+the bounds of the blade direction.  That box, grown by the extrapolation and
+the damage trace box, is tested once:
+
+- against entities: if nothing the damage traces could clip (players, sabers,
+  movers, anything else solid to the mask) is in it, the traces skip the
+  entity clipping pass and with it any G2 collision
+- against the world: if the box is also in open space, no trace of the swing
+  can hit anything and an empty trace is filled in without asking the server
+
+saberstats prints how often each case happens.
+
+=============================================================================
+*/
+
+typedef enum {
+	SWEEP_FULL,		// something may be hit, trace normally
+	SWEEP_WORLD,	// only the world may be hit
+	SWEEP_EMPTY		// nothing may be hit
+} saberSweepMode_t;
+
+static struct {
+	saberSweepMode_t	mode;
+	int					entityNum;
+	int					saberNum, bladeNum;
+	int					clipmask;
+} saberSweep;
+
+static struct {
+	int			swings, worldSwings, emptySwings;
+	int			fullTraces, worldTraces, emptyTraces;
+} saberSweepStats;
+
+// is some at + k*360 inside [a, b]
+static qboolean G_SaberAngleInRange( float a, float b, float at )
+{
+	return ( at + ceilf( (a - at) / 360.0f ) * 360.0f <= b ) ? qtrue : qfalse;
+}
+
+static void G_SaberCosRange( float a, float b, float *lo, float *hi )
+{
+	const float ca = cosf( DEG2RAD( a ) ), cb = cosf( DEG2RAD( b ) );
+
+	*lo = G_SaberAngleInRange( a, b, 180.0f ) ? -1.0f : Q_min( ca, cb );
+	*hi = G_SaberAngleInRange( a, b, 0.0f ) ? 1.0f : Q_max( ca, cb );
+}
+
+static void G_SaberMulRange( float alo, float ahi, float blo, float bhi, float *lo, float *hi )
+{
+	const float p[4] = { alo*blo, alo*bhi, ahi*blo, ahi*bhi };
+
+	*lo = Q_min( Q_min( p[0], p[1] ), Q_min( p[2], p[3] ) );
+	*hi = Q_max( Q_max( p[0], p[1] ), Q_max( p[2], p[3] ) );
+}
+
+// bounds of every direction AngleVectors gives for LerpAngle between the angles of the two directions
+static void G_SaberSweepDirBounds( const vec3_t dirOld, const vec3_t dirNew, vec3_t lo, vec3_t hi )
+{
+	vec3_t angOld, angNew;
+	float pitch[2], yaw[2];
+	float cpLo, cpHi, spLo, spHi, cyLo, cyHi, syLo, syHi;
+
+	vectoangles( dirOld, angOld );
+	vectoangles( dirNew, angNew );
+
+	//LerpAngle at 1 is the end angle it actually heads for
+	pitch[0] = angOld[PITCH];
+	pitch[1] = LerpAngle( angOld[PITCH], angNew[PITCH], 1.0f );
+	yaw[0] = angOld[YAW];
+	yaw[1] = LerpAngle( angOld[YAW], angNew[YAW], 1.0f );
+	if ( pitch[1] < pitch[0] )
+	{
+		float t = pitch[0]; pitch[0] = pitch[1]; pitch[1] = t;
+	}
+	if ( yaw[1] < yaw[0] )
+	{
+		float t = yaw[0]; yaw[0] = yaw[1]; yaw[1] = t;
+	}
+
+	//sin(x) is cos(x - 90)
+	G_SaberCosRange( pitch[0], pitch[1], &cpLo, &cpHi );
+	G_SaberCosRange( pitch[0] - 90.0f, pitch[1] - 90.0f, &spLo, &spHi );
+	G_SaberCosRange( yaw[0], yaw[1], &cyLo, &cyHi );
+	G_SaberCosRange( yaw[0] - 90.0f, yaw[1] - 90.0f, &syLo, &syHi );
+
+	//forward = ( cp*cy, cp*sy, -sp )
+	G_SaberMulRange( cpLo, cpHi, cyLo, cyHi, &lo[0], &hi[0] );
+	G_SaberMulRange( cpLo, cpHi, syLo, syHi, &lo[1], &hi[1] );
+	lo[2] = -spHi;
+	hi[2] = -spLo;
+}
+
+static void G_SaberSweepBegin( gentity_t *self, int saberNum, int bladeNum, const vec3_t baseOld, const vec3_t baseNew,
+	const vec3_t dirOld, const vec3_t dirNew, int clipmask )
+{
+	bladeInfo_t *blade = &self->client->saber[saberNum].blade[bladeNum];
+	int touch[MAX_GENTITIES];
+	vec3_t mins, maxs, dirLo, dirHi, center, halfMins, halfMaxs;
+	float boxSize, grow;
+	trace_t tr;
+	int i, num;
+
+	saberSweep.mode = SWEEP_FULL;
+	if ( !g_saberBroadphase.integer )
+	{
+		return;
+	}
+	saberSweepStats.swings++;
+
+	G_SaberSweepDirBounds( dirOld, dirNew, dirLo, dirHi );
+
+	//largest box CheckSaberDamage may trace with, the extrapolated trace end, and a
+	//little slack for trace epsilons and the blade directions not being exactly unit length
+	boxSize = Q_max( 2.0f, (d_saberBoxTraceSize.value + blade->radius*0.5f)*3.0f );
+	grow = SABER_EXTRAPOLATE_DIST + boxSize + 2.0f;
+
+	for ( i = 0; i < 3; i++ )
+	{
+		mins[i] = Q_min( baseOld[i], baseNew[i] ) + Q_min( 0.0f, blade->lengthMax*dirLo[i] ) - grow;
+		maxs[i] = Q_max( baseOld[i], baseNew[i] ) + Q_max( 0.0f, blade->lengthMax*dirHi[i] ) + grow;
+	}
+
+	num = trap->EntitiesInBox( mins, maxs, touch, MAX_GENTITIES );
+	for ( i = 0; i < num; i++ )
+	{
+		const gentity_t *ent = &g_entities[touch[i]];
+
+		if ( ent == self || !(ent->r.contents & clipmask) )
+		{
+			continue;
+		}
+		if ( ent->r.ownerNum == self->s.number && !(ent->r.svFlags & SVF_OWNERNOTSHARED) )
+		{//the trace skips the owner's own missiles and sabers too
+			continue;
+		}
+		//something the swing may hit, trace it properly
+		return;
+	}
+
+	for ( i = 0; i < 3; i++ )
+	{
+		center[i] = (mins[i] + maxs[i])*0.5f;
+		halfMaxs[i] = maxs[i] - center[i];
+		halfMins[i] = -halfMaxs[i];
+	}
+	trap->TraceWorld( &tr, center, halfMins, halfMaxs, center, clipmask, qfalse );
+
+	if ( tr.startsolid || tr.allsolid )
+	{
+		saberSweepStats.worldSwings++;
+		saberSweep.mode = SWEEP_WORLD;
+	}
+	else
+	{
+		saberSweepStats.emptySwings++;
+		saberSweep.mode = SWEEP_EMPTY;
+	}
+	saberSweep.entityNum = self->s.number;
+	saberSweep.saberNum = saberNum;
+	saberSweep.bladeNum = bladeNum;
+	saberSweep.clipmask = clipmask;
+}
+
+static void G_SaberSweepEnd( void )
+{
+	saberSweep.mode = SWEEP_FULL;
+}
+
+static void G_SaberTrace( trace_t *tr, gentity_t *self, int saberNum, int bladeNum, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int clipmask )
+{
+	if ( saberSweep.mode != SWEEP_FULL
+		&& saberSweep.entityNum == self->s.number
+		&& saberSweep.saberNum == saberNum
+		&& saberSweep.bladeNum == bladeNum
+		&& saberSweep.clipmask == clipmask )
+	{
+		if ( saberSweep.mode == SWEEP_EMPTY )
+		{//the whole swing is known to be in open space, same result the server would give
+			saberSweepStats.emptyTraces++;
+			memset( tr, 0, sizeof( *tr ) );
+			tr->fraction = 1.0f;
+			tr->entityNum = ENTITYNUM_NONE;
+			VectorCopy( end, tr->endpos );
+			return;
+		}
+		//no entity is in reach of the swing, only the world can be hit
+		saberSweepStats.worldTraces++;
+		trap->TraceWorld( tr, start, mins, maxs, end, clipmask, qfalse );
+		return;
+	}
+
+	saberSweepStats.fullTraces++;
+	trap->Trace( tr, start, mins, maxs, end, self->s.number, clipmask, qfalse, 0, 0 );
+}
+
+void Svcmd_SaberStats_f( void )
+{
+	int traces;
+
+	if ( trap->Argc() > 1 )
+	{
+		char arg[MAX_TOKEN_CHARS];
+		trap->Argv( 1, arg, sizeof( arg ) );
+		if ( !Q_stricmp( arg, "reset" ) )
+		{
+			memset( &saberSweepStats, 0, sizeof( saberSweepStats ) );
+			return;
+		}
+	}
+
+	traces = saberSweepStats.fullTraces + saberSweepStats.worldTraces + saberSweepStats.emptyTraces;
+	trap->Print( "saber broadphase %s\n", g_saberBroadphase.integer ? "enabled" : "disabled" );
+	trap->Print( "%d swings: %d with nothing in reach, %d with only the world in reach\n",
+		saberSweepStats.swings, saberSweepStats.emptySwings, saberSweepStats.worldSwings );
+	trap->Print( "%d damage traces: %d skipped (%.1f%%), %d against the world only (%.1f%%)\n", traces,
+		saberSweepStats.emptyTraces, traces ? 100.0 * saberSweepStats.emptyTraces / traces : 0.0,
+		saberSweepStats.worldTraces, traces ? 100.0 * saberSweepStats.worldTraces / traces : 0.0 );
+}
+
 static QINLINE qboolean CheckSaberDamage(gentity_t *self, int rSaberNum, int rBladeNum, vec3_t saberStart, vec3_t saberEnd, qboolean doInterpolate, int trMask, qboolean extrapolate )
 {
 	static trace_t tr;
@@ -4008,7 +4270,7 @@ static QINLINE qboolean CheckSaberDamage(gentity_t *self, int rSaberNum, int rBl
 			{
 				VectorCopy( saberEnd, saberEndExtrapolated );
 			}
-			trap->Trace(&tr, saberStart, saberTrMins, saberTrMaxs, saberEndExtrapolated, self->s.number, trMask, qfalse, 0, 0);
+			G_SaberTrace(&tr, self, rSaberNum, rBladeNum, saberStart, saberTrMins, saberTrMaxs, saberEndExtrapolated, trMask);
 
 			VectorCopy(saberStart, lastValidStart);
 			VectorCopy(saberEndExtrapolated, lastValidEnd);
@@ -5279,6 +5541,8 @@ void G_SPSaberDamageTraceLerped( gentity_t *self, int saberNum, int bladeNum, ve
 		vec3_t baseDiff, bladePointOld, bladePointNew;
 		qboolean extrapolate = qtrue;
 
+		G_SaberSweepBegin( self, saberNum, bladeNum, baseOld, baseNew, md1, md2, clipmask );
+
 		//do the trace at the base first
 		VectorCopy( baseOld, bladePointOld );
 		VectorCopy( baseNew, bladePointNew );
@@ -5431,6 +5695,8 @@ void G_SPSaberDamageTraceLerped( gentity_t *self, int saberNum, int bladeNum, ve
 			hit_wall = qtrue;
 		}
 		*/
+
+		G_SaberSweepEnd();
 	}
 }
 
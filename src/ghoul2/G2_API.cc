@@ -154,9 +154,13 @@ qboolean G2_TestModelPointers(CGhoul2Info *ghlInfo);
 #define NUM_G2T_TIME (2)
 static int G2TimeBases[NUM_G2T_TIME];
 
+// bumped on every time update, skeletons evaluated in an older tick are always rebuilt
+int gG2_TimeTick;
+
 void G2API_SetTime(int currentTime,int clock)
 {
 	assert(clock>=0&&clock<NUM_G2T_TIME);
+	gG2_TimeTick++;
 #if G2_DEBUG_TIME
 	ri.Printf( PRINT_ALL, "Set Time: before c%6d  s%6d",G2TimeBases[1],G2TimeBases[0]);
 #endif
@@ -183,6 +187,24 @@ int	G2API_GetTime(int argTime) // this may or may not return arg depending on gh
 }
 //rww - RAGDOLL_END
 
+// the bone list changed, so nothing evaluated for the current time can be reused
+static inline void G2_FlushSkeleton(CGhoul2Info *ghlInfo)
+{
+	ghlInfo->mSkelFrameNum = 0;
+	if (ghlInfo->mBoneCache)
+	{
+		ghlInfo->mBoneCache->mEvalTick = -1;
+	}
+}
+
+static void G2_FlushSkeletons(CGhoul2Info_v &ghoul2)
+{
+	for (int i = 0; i < ghoul2.size(); i++)
+	{
+		G2_FlushSkeleton(&ghoul2[i]);
+	}
+}
+
 //rww - Stuff to allow association of ghoul2 instances to entity numbers.
 //This way, on listen servers when both the client and server are doing
 //ghoul2 operations, we can copy relevant data off the client instance
@@ -1255,7 +1277,7 @@ qboolean G2API_SetBoneAnimIndex(CGhoul2Info *ghlInfo, const int index, const int
 	if (res)
 	{
 		// ensure we flush the cache
-		ghlInfo->mSkelFrameNum = 0;
+		G2_FlushSkeleton(ghlInfo);
  		return G2_Set_Bone_Anim_Index(ghlInfo->mBlist, index, startFrame, endFrame, flags, animSpeed, currentTime, setFrame, blendTime, ghlInfo->aHeader->numFrames);
 	}
 	return qfalse;
@@ -1330,7 +1352,7 @@ qboolean G2API_SetBoneAnim(CGhoul2Info_v &ghoul2, const int modelIndex, const ch
 		if (res)
 		{
 			// ensure we flush the cache
-			ghlInfo->mSkelFrameNum = 0;
+			G2_FlushSkeleton(ghlInfo);
  			return G2_Set_Bone_Anim(ghlInfo, ghlInfo->mBlist, boneName, startFrame, endFrame, flags, animSpeed, currentTime, setFrame, blendTime);
 		}
 	}
@@ -1429,6 +1451,7 @@ qboolean G2API_PauseBoneAnim(CGhoul2Info *ghlInfo, const char *boneName, const i
 {
 	if (G2_SetupModelPointers(ghlInfo))
 	{
+		G2_FlushSkeleton(ghlInfo);
  		return G2_Pause_Bone_Anim(ghlInfo, ghlInfo->mBlist, boneName, currentTime);
 	}
 	return qfalse;
@@ -1447,6 +1470,7 @@ qboolean G2API_StopBoneAnimIndex(CGhoul2Info *ghlInfo, const int index)
 {
 	if (G2_SetupModelPointers(ghlInfo))
 	{
+		G2_FlushSkeleton(ghlInfo);
  		return G2_Stop_Bone_Anim_Index(ghlInfo->mBlist, index);
 	}
 	return qfalse;
@@ -1456,6 +1480,7 @@ qboolean G2API_StopBoneAnim(CGhoul2Info *ghlInfo, const char *boneName)
 {
 	if (G2_SetupModelPointers(ghlInfo))
 	{
+		G2_FlushSkeleton(ghlInfo);
  		return G2_Stop_Bone_Anim(ghlInfo->mFileName, ghlInfo->mBlist, boneName);
 	}
 	return qfalse;
@@ -1492,7 +1517,7 @@ qboolean G2API_SetBoneAnglesIndex(CGhoul2Info *ghlInfo, const int index, const v
 	if (res)
 	{
 		// ensure we flush the cache
-		ghlInfo->mSkelFrameNum = 0;
+		G2_FlushSkeleton(ghlInfo);
 		return G2_Set_Bone_Angles_Index( ghlInfo->mBlist, index, angles, flags, yaw, pitch, roll, modelList, ghlInfo->mModelindex, blendTime, currentTime);
 	}
 	return qfalse;
@@ -1532,7 +1557,7 @@ qboolean G2API_SetBoneAngles(CGhoul2Info_v &ghoul2, const int modelIndex, const
 		if (res)
 		{
 				// ensure we flush the cache
-			ghlInfo->mSkelFrameNum = 0;
+			G2_FlushSkeleton(ghlInfo);
 			return G2_Set_Bone_Angles(ghlInfo, ghlInfo->mBlist, boneName, angles, flags, up, left, forward, modelList, ghlInfo->mModelindex, blendTime, currentTime);
 		}
 	}
@@ -1545,7 +1570,7 @@ qboolean G2API_SetBoneAnglesMatrixIndex(CGhoul2Info *ghlInfo, const int index, c
 	if (G2_SetupModelPointers(ghlInfo))
 	{
 		// ensure we flush the cache
-		ghlInfo->mSkelFrameNum = 0;
+		G2_FlushSkeleton(ghlInfo);
 		return G2_Set_Bone_Angles_Matrix_Index(ghlInfo->mBlist, index, matrix, flags, modelList, ghlInfo->mModelindex, blendTime, currentTime);
 	}
 	return qfalse;
@@ -1557,7 +1582,7 @@ qboolean G2API_SetBoneAnglesMatrix(CGhoul2Info *ghlInfo, const char *boneName, c
 	if (G2_SetupModelPointers(ghlInfo))
 	{
 		// ensure we flush the cache
-		ghlInfo->mSkelFrameNum = 0;
+		G2_FlushSkeleton(ghlInfo);
 		return G2_Set_Bone_Angles_Matrix(ghlInfo->mFileName, ghlInfo->mBlist, boneName, matrix, flags, modelList, ghlInfo->mModelindex, blendTime, currentTime);
 	}
 	return qfalse;
@@ -1568,7 +1593,7 @@ qboolean G2API_StopBoneAnglesIndex(CGhoul2Info *ghlInfo, const int index)
 	if (G2_SetupModelPointers(ghlInfo))
 	{
 		// ensure we flush the cache
-		ghlInfo->mSkelFrameNum = 0;
+		G2_FlushSkeleton(ghlInfo);
  		return G2_Stop_Bone_Angles_Index(ghlInfo->mBlist, index);
 	}
 	return qfalse;
@@ -1579,7 +1604,7 @@ qboolean G2API_StopBoneAngles(CGhoul2Info *ghlInfo, const char *boneName)
 	if (G2_SetupModelPointers(ghlInfo))
 	{
 		// ensure we flush the cache
-		ghlInfo->mSkelFrameNum = 0;
+		G2_FlushSkeleton(ghlInfo);
  		return G2_Stop_Bone_Angles(ghlInfo->mFileName, ghlInfo->mBlist, boneName);
 	}
 	return qfalse;
@@ -1606,12 +1631,14 @@ class CRagDollParams;
 void G2_SetRagDoll(CGhoul2Info_v &ghoul2V,CRagDollParams *parms);
 void G2API_SetRagDoll(CGhoul2Info_v &ghoul2,CRagDollParams *parms)
 {
+	G2_FlushSkeletons(ghoul2);
 	G2_SetRagDoll(ghoul2,parms);
 }
 
 void G2_ResetRagDoll(CGhoul2Info_v &ghoul2V);
 void G2API_ResetRagDoll(CGhoul2Info_v &ghoul2)
 {
+	G2_FlushSkeletons(ghoul2);
 	G2_ResetRagDoll(ghoul2);
 }
 //rww - RAGDOLL_END
@@ -1623,7 +1650,7 @@ qboolean G2API_RemoveBone(CGhoul2Info_v& ghoul2, int modelIndex, const char *bon
 	if (G2_SetupModelPointers(ghlInfo))
 	{
 		// ensure we flush the cache
-		ghlInfo->mSkelFrameNum = 0;
+		G2_FlushSkeleton(ghlInfo);
  		return G2_Remove_Bone(ghlInfo, ghlInfo->mBlist, boneName);
 	}
 	return qfalse;
@@ -1817,12 +1844,14 @@ qboolean G2API_RagForceSolve(CGhoul2Info_v &ghoul2, qboolean force)
 qboolean G2_SetBoneIKState(CGhoul2Info_v &ghoul2, int time, const char *boneName, int ikState, sharedSetBoneIKStateParams_t *params);
 qboolean G2API_SetBoneIKState(CGhoul2Info_v &ghoul2, int time, const char *boneName, int ikState, sharedSetBoneIKStateParams_t *params)
 {
+	G2_FlushSkeletons(ghoul2);
 	return G2_SetBoneIKState(ghoul2, time, boneName, ikState, params);
 }
 
 qboolean G2_IKMove(CGhoul2Info_v &ghoul2, int time, sharedIKMoveParams_t *params);
 qboolean G2API_IKMove(CGhoul2Info_v &ghoul2, int time, sharedIKMoveParams_t *params)
 {
+	G2_FlushSkeletons(ghoul2);
 	return G2_IKMove(ghoul2, time, params);
 }
 
@@ -24,6 +24,9 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 
 #include "g2_local.hh"
 
+#include <unordered_map>
+#include <unordered_set>
+
 //rww - RAGDOLL_BEGIN
 #ifndef __linux__
 #include <float.h>
@@ -3370,10 +3373,100 @@ static int G2_GetBonePoolIndex(	const mdxaHeader_t *pMDXAHeader, int iFrame, int
 #endif
 }
 
-static inline void UnCompressBone(float mat[3][4], int iBoneIndex, const mdxaHeader_t *pMDXAHeader, int iFrame)
+// Every instance animating with the same GLA reads the same compressed bone pool, so the pool is
+// decompressed once per GLA and shared. Entries are filled in the first time a frame references them.
+class CBonePool
+{
+public:
+	const mdxaHeader_t			*header;
+	mdxaHeader_t				ident;		// copy of the header this pool was built from
+	const mdxaCompQuatBone_t	*comp;
+	std::vector<mdxaBone_t>		bones;
+	std::vector<byte>			valid;
+
+	void Setup(const mdxaHeader_t *aheader)
+	{
+		header = aheader;
+		ident = *header;
+		comp = (const mdxaCompQuatBone_t *)((const byte *)header + header->ofsCompBonePool);
+		// the pool is the last thing in the file and its size isn't stored
+		const int numPool = (header->ofsEnd - header->ofsCompBonePool) / sizeof(mdxaCompQuatBone_t);
+		bones.resize(numPool);
+		valid.assign(numPool, 0);
+	}
+
+	const mdxaBone_t &Bone(int index)
+	{
+		assert(index >= 0 && index < (int)bones.size());
+		if (!valid[index])
+		{
+			MC_UnCompressQuat(bones[index].matrix, comp[index].Comp);
+			valid[index] = 1;
+		}
+		return bones[index];
+	}
+};
+
+static std::unordered_map<const mdxaHeader_t *, CBonePool> g2BonePools;
+
+// The renderer frees GLAs that weren't used on the new level without telling
+// ghoul2 (a dedicated server never shuts ghoul2 down at all), and a reloaded GLA
+// lands at a new address, so drop the pools of every header no model uses anymore.
+static void G2_PruneBonePools(void)
+{
+	std::unordered_set<const mdxaHeader_t *> registered;
+	const model_t *defaultModel = g2_re.GetModelByHandle(0);
+	for (qhandle_t handle = 1; ; handle++)
+	{
+		const model_t *mod = g2_re.GetModelByHandle(handle);
+		if (mod == defaultModel)
+		{
+			break;
+		}
+		if (mod->mdxa)
+		{
+			registered.insert(mod->mdxa);
+		}
+	}
+
+	for (auto it = g2BonePools.begin(); it != g2BonePools.end(); )
+	{
+		if (registered.count(it->first))
+		{
+			++it;
+		}
+		else
+		{
+			it = g2BonePools.erase(it);
+		}
+	}
+}
+
+CBonePool *G2_GetBonePool(const mdxaHeader_t *header)
+{
+	auto found = g2BonePools.find(header);
+	if (found == g2BonePools.end())
+	{//first use of this header, a good time to forget the ones that are gone
+		G2_PruneBonePools();
+	}
+
+	CBonePool &pool = g2BonePools[header];
+	// a freed GLA's memory may since have been reused for another one
+	if (memcmp(&pool.ident, header, sizeof(mdxaHeader_t)))
+	{
+		pool.Setup(header);
+	}
+	return &pool;
+}
+
+void G2_ClearBonePools(void)
+{
+	g2BonePools.clear();
+}
+
+static inline const mdxaBone_t &UnCompressBone(CBonePool &pool, int iBoneIndex, int iFrame)
 {
-	mdxaCompQuatBone_t *pCompBonePool = (mdxaCompQuatBone_t *) ((byte *)pMDXAHeader + pMDXAHeader->ofsCompBonePool);
-	MC_UnCompressQuat(mat, pCompBonePool[ G2_GetBonePoolIndex( pMDXAHeader, iFrame, iBoneIndex ) ].Comp);
+	return pool.Bone(G2_GetBonePoolIndex(pool.header, iFrame, iBoneIndex));
 }
 
 void G2_RagGetAnimMatrix(CGhoul2Info &ghoul2, const int boneNum, mdxaBone_t &matrix, const int frame)
@@ -3423,7 +3516,8 @@ void G2_RagGetAnimMatrix(CGhoul2Info &ghoul2, const int boneNum, mdxaBone_t &mat
 	}
 
 	//get the base matrix for the specified frame
-	UnCompressBone(animMatrix.matrix, boneNum, ghoul2.mBoneCache->header, frame);
+	assert(ghoul2.mBoneCache->bonePool);
+	animMatrix = UnCompressBone(*ghoul2.mBoneCache->bonePool, boneNum, frame);
 
 	parent = skel->parent;
 	if (boneNum > 0 && parent > -1)
@@ -5039,7 +5133,7 @@ void G2_TransformBone (int child,CBoneCache &BC)
 	static mdxaSkel_t		*skel;
 	static mdxaSkelOffsets_t *offsets;
 	boneInfo_v		&boneList = *BC.rootBoneList;
-	static int				j, boneListIndex;
+	static int				boneListIndex;
 	int				angleOverride = 0;
 
 #if DEBUG_G2_TIMING
@@ -5186,22 +5280,16 @@ void G2_TransformBone (int child,CBoneCache &BC)
 
 	// decide where the transformed bone is going
 
+	CBonePool &pool = *BC.bonePool;
+
 	// are we blending with another frame of anim?
 	if (TB.blendMode)
 	{
 		float backlerp = TB.blendFrame - (int)TB.blendFrame;
 		float frontlerp = 1.0 - backlerp;
 
-// 		MC_UnCompress(tbone[3].matrix,compBonePointer[bFrame->boneIndexes[child]].Comp);
-// 		MC_UnCompress(tbone[4].matrix,compBonePointer[boldFrame->boneIndexes[child]].Comp);
-		UnCompressBone(tbone[3].matrix, child, BC.header, TB.blendFrame);
-		UnCompressBone(tbone[4].matrix, child, BC.header, TB.blendOldFrame);
-
-		for ( j = 0 ; j < 12 ; j++ )
-		{
-  			((float *)&tbone[5])[j] = (backlerp * ((float *)&tbone[3])[j])
-				+ (frontlerp * ((float *)&tbone[4])[j]);
-		}
+		Lerp_3x4Matrix(&tbone[5], &UnCompressBone(pool, child, (int)TB.blendFrame), backlerp,
+			&UnCompressBone(pool, child, TB.blendOldFrame), frontlerp);
 	}
 
   	//
@@ -5209,57 +5297,28 @@ void G2_TransformBone (int child,CBoneCache &BC)
   	//
   	if (!TB.backlerp)
   	{
-// 		MC_UnCompress(tbone[2].matrix,compBonePointer[aoldFrame->boneIndexes[child]].Comp);
-		UnCompressBone(tbone[2].matrix, child, BC.header, TB.currentFrame);
-
-		// blend in the other frame if we need to
-		if (TB.blendMode)
-		{
-			float blendFrontlerp = 1.0 - TB.blendLerp;
-	  		for ( j = 0 ; j < 12 ; j++ )
-			{
-  				((float *)&tbone[2])[j] = (TB.blendLerp * ((float *)&tbone[2])[j])
-					+ (blendFrontlerp * ((float *)&tbone[5])[j]);
-			}
-		}
-
-  		if (!child)
-		{
-			// now multiply by the root matrix, so we can offset this model should we need to
-			Multiply_3x4Matrix(&BC.mFinalBones[child].boneMatrix, &BC.rootMatrix, &tbone[2]);
- 		}
-  	}
+		tbone[2] = UnCompressBone(pool, child, TB.currentFrame);
+	}
 	else
   	{
 		float frontlerp = 1.0 - TB.backlerp;
-// 		MC_UnCompress(tbone[0].matrix,compBonePointer[aFrame->boneIndexes[child]].Comp);
-//		MC_UnCompress(tbone[1].matrix,compBonePointer[aoldFrame->boneIndexes[child]].Comp);
-		UnCompressBone(tbone[0].matrix, child, BC.header, TB.newFrame);
-		UnCompressBone(tbone[1].matrix, child, BC.header, TB.currentFrame);
-
-		for ( j = 0 ; j < 12 ; j++ )
-		{
-  			((float *)&tbone[2])[j] = (TB.backlerp * ((float *)&tbone[0])[j])
-				+ (frontlerp * ((float *)&tbone[1])[j]);
-		}
+		Lerp_3x4Matrix(&tbone[2], &UnCompressBone(pool, child, TB.newFrame), TB.backlerp,
+			&UnCompressBone(pool, child, TB.currentFrame), frontlerp);
+	}
 
-		// blend in the other frame if we need to
-		if (TB.blendMode)
-		{
-			float blendFrontlerp = 1.0 - TB.blendLerp;
-	  		for ( j = 0 ; j < 12 ; j++ )
-			{
-  				((float *)&tbone[2])[j] = (TB.blendLerp * ((float *)&tbone[2])[j])
-					+ (blendFrontlerp * ((float *)&tbone[5])[j]);
-			}
-		}
+	// blend in the other frame if we need to
+	if (TB.blendMode)
+	{
+		float blendFrontlerp = 1.0 - TB.blendLerp;
+		Lerp_3x4Matrix(&tbone[2], &tbone[2], TB.blendLerp, &tbone[5], blendFrontlerp);
+	}
 
-  		if (!child)
-  		{
-			// now multiply by the root matrix, so we can offset this model should we need to
-			Multiply_3x4Matrix(&BC.mFinalBones[child].boneMatrix, &BC.rootMatrix, &tbone[2]);
-  		}
+	if (!child)
+	{
+		// now multiply by the root matrix, so we can offset this model should we need to
+		Multiply_3x4Matrix(&BC.mFinalBones[child].boneMatrix, &BC.rootMatrix, &tbone[2]);
 	}
+
 	// figure out where the bone hirearchy info is
 	offsets = (mdxaSkelOffsets_t *)((byte *)BC.header + sizeof(mdxaHeader_t));
 	skel = (mdxaSkel_t *)((byte *)BC.header + sizeof(mdxaHeader_t) + offsets->offsets[child]);
@@ -5320,11 +5379,7 @@ void G2_TransformBone (int child,CBoneCache &BC)
 //					mdxaBone_t lerp;
 					// now do the blend into the destination
 					float blendFrontlerp = 1.0 - blendLerp;
-	  				for ( j = 0 ; j < 12 ; j++ )
-					{
-  						((float *)&bone)[j] = (blendLerp * ((float *)&temp)[j])
-							+ (blendFrontlerp * ((float *)&tbone[2])[j]);
-					}
+					Lerp_3x4Matrix(&bone, &temp, blendLerp, &tbone[2], blendFrontlerp);
 //					Multiply_3x4Matrix(&bone, &BC.mFinalBones[parent].boneMatrix,&lerp);
 				}
 			}
@@ -5390,11 +5445,7 @@ void G2_TransformBone (int child,CBoneCache &BC)
 
 					// now do the blend into the destination
 					float blendFrontlerp = 1.0 - blendLerp;
-	  				for ( j = 0 ; j < 12 ; j++ )
-					{
-  						((float *)&bone)[j] = (blendLerp * ((float *)&temp)[j])
-							+ (blendFrontlerp * ((float *)&firstPass)[j]);
-					}
+					Lerp_3x4Matrix(&bone, &temp, blendLerp, &firstPass, blendFrontlerp);
 				}
 				else
 				{
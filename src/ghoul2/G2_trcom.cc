@@ -691,6 +691,23 @@ void G2_SetUpBolts( mdxaHeader_t *header, CGhoul2Info &ghoul2, mdxaBone_v &boneP
 //rww - RAGDOLL_END
 //rwwFIXMEFIXME: Move this into the stupid header or something.
 
+// ragdoll and ik solvers move bones between evaluations at the same time
+static bool G2_IsSimulated(const CGhoul2Info &ghoul2,const boneInfo_v &rootBoneList)
+{
+	if (ghoul2.mFlags&GHOUL2_RAG_STARTED)
+	{
+		return true;
+	}
+	for (size_t i=0;i<rootBoneList.size();i++)
+	{
+		if (rootBoneList[i].boneNumber!=-1&&(rootBoneList[i].flags&(BONE_ANGLES_RAGDOLL|BONE_ANGLES_IK)))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
 void G2_TransformGhoulBones(boneInfo_v &rootBoneList,mdxaBone_t &rootMatrix, CGhoul2Info &ghoul2, int time,bool smooth)
 {
 
@@ -729,8 +746,13 @@ void G2_TransformGhoulBones(boneInfo_v &rootBoneList,mdxaBone_t &rootMatrix, CGh
 		g_Ghoul2Allocations += sizeof(*ghoul2.mBoneCache);
 #endif
 	}
+	if (ghoul2.mBoneCache->mod!=currentModel||ghoul2.mBoneCache->header!=aHeader)
+	{
+		ghoul2.mBoneCache->mEvalTick=-1;
+	}
 	ghoul2.mBoneCache->mod=currentModel;
 	ghoul2.mBoneCache->header=aHeader;
+	ghoul2.mBoneCache->bonePool=G2_GetBonePool(aHeader);
 	assert(ghoul2.mBoneCache->mBones.size()==(unsigned)aHeader->numBones);
 
 	ghoul2.mBoneCache->mSmoothingActive=false;
@@ -814,6 +836,19 @@ void G2_TransformGhoulBones(boneInfo_v &rootBoneList,mdxaBone_t &rootMatrix, CGh
 		ghoul2.mBoneCache->mSmoothFactor=1.0f;
 	}
 
+	// bolt and collision queries rebuild the skeleton every call, but within one G2API_SetTime tick
+	// the bones only change if the time, root or bone list does, so keep what was evaluated already
+	if (ghoul2.mBoneCache->mEvalTick==gG2_TimeTick &&
+		ghoul2.mBoneCache->incomingTime==time &&
+		ghoul2.mBoneCache->rootBoneList==&rootBoneList &&
+		!ghoul2.mBoneCache->mSmoothingActive &&
+		!memcmp(&ghoul2.mBoneCache->rootMatrix,&rootMatrix,sizeof(mdxaBone_t)) &&
+		!G2_IsSimulated(ghoul2,rootBoneList))
+	{
+		return;
+	}
+	ghoul2.mBoneCache->mEvalTick=ghoul2.mBoneCache->mSmoothingActive?-1:gG2_TimeTick;
+
 	ghoul2.mBoneCache->mCurrentTouch++;
 
 //rww - RAGDOLL_BEGIN
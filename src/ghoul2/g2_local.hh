@@ -77,6 +77,8 @@ qboolean	G2_Stop_Bone_Anim_Index(boneInfo_v &blist, const int index);
 qboolean	G2_Stop_Bone_Angles_Index(boneInfo_v &blist, const int index);
 qboolean	G2_Set_Bone_Anim_Index(boneInfo_v &blist, const int index, const int startFrame, const int endFrame, const int flags, const float animSpeed, const int currentTime, const float setFrame, const int blendTime, const int numFrames);
 qboolean	G2_Get_Bone_Anim_Index( boneInfo_v &blist, const int index, const int currentTime, float *currentFrame, int *startFrame, int *endFrame, int *flags, float *retAnimSpeed, qhandle_t *modelList, int modelIndex);
+CBonePool	*G2_GetBonePool(const mdxaHeader_t *header);
+void		G2_ClearBonePools(void);
 
 // misc functions G2_misc.cpp
 void		G2_List_Model_Surfaces(const char *fileName);
@@ -227,6 +229,7 @@ qboolean	G2API_OverrideServerWithClientData(CGhoul2Info_v& ghoul2, int modelInde
 
 extern qboolean gG2_GBMNoReconstruct;
 extern qboolean gG2_GBMUseSPMethod;
+extern int gG2_TimeTick;
 // From tr_ghoul2.cpp
 void		G2_ConstructGhoulSkeleton( CGhoul2Info_v &ghoul2,const int frameNum,bool checkForNewOrigin,const vec3_t scale);
 
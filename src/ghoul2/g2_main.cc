@@ -47,6 +47,8 @@ static void G2_Shutdown(qboolean restarting) {
 #ifndef DEDICATED
 	if (restarting) SaveGhoul2InfoArray();
 #endif
+	// restored instances may still point at their pools, stale ones are revalidated on use
+	if (!restarting) G2_ClearBonePools();
 }
 
 extern "C" Q_EXPORT g2export_t * QDECL G2_GetInterface() {
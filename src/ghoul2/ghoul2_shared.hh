@@ -31,6 +31,11 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "qcommon/matcomp.hh"
 #include "G2_gore.hh"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define G2_SSE2
+	#include <emmintrin.h>
+#endif
+
 struct model_s;
 
 //rww - RAGDOLL_BEGIN
@@ -41,6 +46,21 @@ struct model_s;
 
 static inline void Multiply_3x4Matrix(mdxaBone_t *out, mdxaBone_t *in2, mdxaBone_t *in)
 {
+#ifdef G2_SSE2
+	// each row of out is a weighted sum of the rows of in, plus the translation of in2.
+	// Same sums as the scalar code, except the rotation columns also get 0.0f added,
+	// which turns a -0.0 there into +0.0
+	const __m128 r0 = _mm_loadu_ps(in->matrix[0]);
+	const __m128 r1 = _mm_loadu_ps(in->matrix[1]);
+	const __m128 r2 = _mm_loadu_ps(in->matrix[2]);
+	for (int i = 0; i < 3; i++)
+	{
+		const float *row = in2->matrix[i];
+		__m128 t = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(row[0]), r0), _mm_mul_ps(_mm_set1_ps(row[1]), r1));
+		t = _mm_add_ps(t, _mm_mul_ps(_mm_set1_ps(row[2]), r2));
+		_mm_storeu_ps(out->matrix[i], _mm_add_ps(t, _mm_set_ps(row[3], 0.0f, 0.0f, 0.0f)));
+	}
+#else
 	// first row of out
 	out->matrix[0][0] = (in2->matrix[0][0] * in->matrix[0][0]) + (in2->matrix[0][1] * in->matrix[1][0]) + (in2->matrix[0][2] * in->matrix[2][0]);
 	out->matrix[0][1] = (in2->matrix[0][0] * in->matrix[0][1]) + (in2->matrix[0][1] * in->matrix[1][1]) + (in2->matrix[0][2] * in->matrix[2][1]);
@@ -56,6 +76,25 @@ static inline void Multiply_3x4Matrix(mdxaBone_t *out, mdxaBone_t *in2, mdxaBone
 	out->matrix[2][1] = (in2->matrix[2][0] * in->matrix[0][1]) + (in2->matrix[2][1] * in->matrix[1][1]) + (in2->matrix[2][2] * in->matrix[2][1]);
 	out->matrix[2][2] = (in2->matrix[2][0] * in->matrix[0][2]) + (in2->matrix[2][1] * in->matrix[1][2]) + (in2->matrix[2][2] * in->matrix[2][2]);
 	out->matrix[2][3] = (in2->matrix[2][0] * in->matrix[0][3]) + (in2->matrix[2][1] * in->matrix[1][3]) + (in2->matrix[2][2] * in->matrix[2][3]) + in2->matrix[2][3];
+#endif
+}
+
+// out = (alerp * a) + (blerp * b), element by element
+static inline void Lerp_3x4Matrix(mdxaBone_t *out, const mdxaBone_t *a, float alerp, const mdxaBone_t *b, float blerp)
+{
+#ifdef G2_SSE2
+	const __m128 wa = _mm_set1_ps(alerp);
+	const __m128 wb = _mm_set1_ps(blerp);
+	for (int i = 0; i < 3; i++)
+	{
+		_mm_storeu_ps(out->matrix[i], _mm_add_ps(_mm_mul_ps(wa, _mm_loadu_ps(a->matrix[i])), _mm_mul_ps(wb, _mm_loadu_ps(b->matrix[i]))));
+	}
+#else
+	for (int j = 0; j < 12; j++)
+	{
+		((float *)out)[j] = (alerp * ((const float *)a)[j]) + (blerp * ((const float *)b)[j]);
+	}
+#endif
 }
 
 //===================================================================
@@ -412,6 +451,7 @@ struct SBoneCalc
 
 
 class CBoneCache;
+class CBonePool;
 void G2_TransformBone(int index,CBoneCache &CB);
 
 class CBoneCache
@@ -553,6 +593,11 @@ public:
 	bool			mUnsquash;
 	float			mSmoothFactor;
 
+	// decompressed animation frames of header, shared with every other instance of that skeleton
+	CBonePool		*bonePool;
+	// G2API_SetTime tick the bones were last evaluated for, -1 forces a full re-evaluation
+	int				mEvalTick;
+
 	CBoneCache(const model_t *amod,const mdxaHeader_t *aheader) :
 		header(aheader),
 		mod(amod)
@@ -562,6 +607,8 @@ public:
 		mSmoothingActive=false;
 		mUnsquash=false;
 		mSmoothFactor=0.0f;
+		bonePool=0;
+		mEvalTick=-1;
 
 		int numBones=header->numBones;
 		mBones.resize(numBones);
@@ -47,7 +47,7 @@ CROFFSystem::CROFF::CROFF( const char *file, int id )
 
 	mID				= id;
 	mMoveRotateList = NULL;
-	mNoteTrackIndexes = 0;
+	mNumNoteTracks	= 0;
 	mUsedByClient = mUsedByServer = qfalse;
 }
 
@@ -68,12 +68,6 @@ CROFFSystem::CROFF::~CROFF()
 	{
 		delete [] mMoveRotateList;
 	}
-
-	if (mNoteTrackIndexes)
-	{
-		delete mNoteTrackIndexes[0];
-		delete [] mNoteTrackIndexes;
-	}
 }
 
 
@@ -99,6 +93,7 @@ qboolean CROFFSystem::Restart()
 		mROFFList.erase( itr );
 		itr = mROFFList.begin();
 	}
+	mROFFIDLookup.clear();
 
 	// clear CROFFSystem unique ID counter
 	mID = 0;
@@ -172,7 +167,6 @@ qboolean CROFFSystem::InitROFF( unsigned char *data, CROFF *obj )
 	obj->mFrameTime			= 1000 / ROFF_SAMPLE_RATE;		// default 10 hz
 	obj->mLerp				= ROFF_SAMPLE_RATE;
 	obj->mNumNoteTracks		= 0;
-	obj->mNoteTrackIndexes	= 0;
 
 	if ( obj->mMoveRotateList != 0 )
 	{ // Step past the header to get to the goods
@@ -255,25 +249,30 @@ qboolean CROFFSystem::InitROFF2( unsigned char *data, CROFF *obj )
 
 		if (obj->mNumNoteTracks)
 		{
-			size_t	size = 0;
-			char	*ptr, *start;
-
-			ptr = start = (char *)&roff_data[i];
+			const char *ptr = (const char *)&roff_data[i];
 
+			obj->mNoteEvents.reserve(obj->mNumNoteTracks);
 			for(i=0;i<obj->mNumNoteTracks;i++)
 			{
-				size += strlen(ptr) + 1;
+				SplitNote(obj, ptr);
 				ptr += strlen(ptr) + 1;
 			}
 
-			obj->mNoteTrackIndexes = new char *[obj->mNumNoteTracks];
-			ptr = obj->mNoteTrackIndexes[0] = new char[size];
-			memcpy(obj->mNoteTrackIndexes[0], start, size);
-
-			for(i=1;i<obj->mNumNoteTracks;i++)
+			// drop note references that point past the note table
+			for(i=0;i<obj->mROFFEntries;i++)
 			{
-				ptr += strlen(ptr) + 1;
-				obj->mNoteTrackIndexes[i] = ptr;
+				TROFF2Entry &entry = obj->mMoveRotateList[i];
+				if (entry.mStartNote >= 0 && entry.mStartNote + entry.mNumNotes > obj->mNumNoteTracks)
+				{
+					entry.mNumNotes = Q_max(obj->mNumNoteTracks - entry.mStartNote, 0);
+				}
+			}
+		}
+		else
+		{
+			for(i=0;i<obj->mROFFEntries;i++)
+			{
+				obj->mMoveRotateList[i].mStartNote = -1;
 			}
 		}
 	}
@@ -381,6 +380,7 @@ int CROFFSystem::Cache( const char *file, qboolean isClient )
 		cROFF = new CROFF( file, id );
 
 		mROFFList[id] = cROFF;
+		mROFFIDLookup[file] = id;
 
 		if ( !InitROFF( data, cROFF ) )
 		{ // something failed, so get rid of the object
@@ -418,19 +418,15 @@ int CROFFSystem::Cache( const char *file, qboolean isClient )
 //---------------------------------------------------------------------------
 int	CROFFSystem::GetID( const char *file )
 {
-	TROFFList::iterator itr;
+	auto itr = mROFFIDLookup.find( file );
 
-	// Attempt to find the requested roff
-	for ( itr = mROFFList.begin(); itr != mROFFList.end(); ++itr )
+	// Not found
+	if ( itr == mROFFIDLookup.end() )
 	{
-		if ( !strcmp( ((CROFF *)((*itr).second))->mROFFFilePath, file ) )
-		{ // return the ID to this roff
-			return (*itr).first;
-		}
+		return 0;
 	}
 
-	// Not found
-	return 0;
+	return itr->second;
 }
 
 
@@ -453,6 +449,15 @@ qboolean CROFFSystem::Unload( int id )
 
 	if ( itr != mROFFList.end() )
 	{ // requested item found in the list, free mem, then remove from list
+		for ( SROFFEntity *roff_ent : mROFFEntList )
+		{ // anyone still playing it gets purged on the next update
+			if ( roff_ent->mROFF == itr->second )
+			{
+				roff_ent->mROFF = NULL;
+			}
+		}
+
+		mROFFIDLookup.erase( itr->second->mROFFFilePath );
 		delete itr->second;
 
 		mROFFList.erase( itr++ );
@@ -643,10 +648,13 @@ qboolean CROFFSystem::Play( int entID, int id, qboolean doTranslation, qboolean
 		//bjg TODO: reset this latter?
 	}
 
+	TROFFList::iterator itr = mROFFList.find( id );
+
 	SROFFEntity *roffing_ent = new SROFFEntity;
 
 	roffing_ent->mEntID			= entID;
 	roffing_ent->mROFFID		= id;
+	roffing_ent->mROFF			= (itr == mROFFList.end()) ? NULL : itr->second;
 	roffing_ent->mNextROFFTime	= svs.time;
 	roffing_ent->mROFFFrame		= 0;
 	roffing_ent->mKill			= qfalse;
@@ -656,6 +664,11 @@ qboolean CROFFSystem::Play( int entID, int id, qboolean doTranslation, qboolean
 
 	if ( !isClient )
 		VectorCopy(ent->s.apos.trBase, roffing_ent->mStartAngles);
+	else
+		VectorClear(roffing_ent->mStartAngles);
+
+	// the start angles never change, so do this once instead of every frame
+	AngleVectors(roffing_ent->mStartAngles, roffing_ent->mStartAxis[0], roffing_ent->mStartAxis[1], roffing_ent->mStartAxis[2]);
 
 	mROFFEntList.push_back( roffing_ent );
 
@@ -784,66 +797,45 @@ qboolean CROFFSystem::PurgeEnt( char *name )
 //---------------------------------------------------------------------------
 void CROFFSystem::UpdateEntities(qboolean isClient)
 {
-	TROFFEntList::iterator itr = mROFFEntList.begin();
-	TROFFList::iterator itrRoff;
-
-	// display everything in the entity list
-	for ( itr = mROFFEntList.begin(); itr != mROFFEntList.end(); ++itr )
+	// apply everything in the entity list
+	for ( SROFFEntity *roff_ent : mROFFEntList )
 	{
-		if ((*itr)->mIsClient != isClient)
+		if (roff_ent->mIsClient != isClient)
 		{
 			continue;
 		}
 
-		// Get this entities ROFF object
-		itrRoff = mROFFList.find( ((SROFFEntity *)(*itr))->mROFFID );
-
-		if ( itrRoff != mROFFList.end() )
+		if ( roff_ent->mROFF )
 		{ // roff that baby!
-			if ( !ApplyROFF( ((SROFFEntity *)(*itr)), ((CROFF *)((*itrRoff).second ))))
+			if ( !ApplyROFF( roff_ent, roff_ent->mROFF ) )
 			{ // done roffing, mark for death
-				((SROFFEntity *)(*itr))->mKill = qtrue;
+				roff_ent->mKill = qtrue;
 			}
 		}
 		else
 		{ // roff not found == bad, dump an error message and purge this ent
 			Com_Printf( S_COLOR_RED"ROFF System Error:\n" );
-//			Com_Printf( S_COLOR_RED" -ROFF not found for entity <%s>\n",
-//					entitySystem->GetEntityFromID(((SROFFEntity *)(*itr))->mEntID)->GetName() );
 
-			((SROFFEntity *)(*itr))->mKill = qtrue;
+			roff_ent->mKill = qtrue;
 
-			ClearLerp( (*itr) );
+			ClearLerp( roff_ent );
 		}
 	}
 
-	itr = mROFFEntList.begin();
-
-	// Delete killed ROFFers from the list
-	// Man, there just has to be a better way to do this
-	while ( itr != mROFFEntList.end() )
-	{
-		if ((*itr)->mIsClient != isClient)
-		{
-			itr++;
-			continue;
-		}
-
-		if ( ((SROFFEntity *)(*itr))->mKill == qtrue )
-		{
-			//make sure ICARUS knows ROFF is stopped
-//			CICARUSGameInterface::TaskIDComplete(
-//				entitySystem->GetEntityFromID(((SROFFEntity *)(*itr))->mEntID), TID_MOVE);
-			// trash this guy from the list
-			delete (*itr);
-			mROFFEntList.erase( itr );
-			itr = mROFFEntList.begin();
-		}
-		else
+	// Delete killed ROFFers from the list in one pass
+	auto killed = std::remove_if( mROFFEntList.begin(), mROFFEntList.end(), [isClient](SROFFEntity *roff_ent) {
+		if ( roff_ent->mIsClient != isClient || !roff_ent->mKill )
 		{
-			itr++;
+			return false;
 		}
-	}
+		//make sure ICARUS knows ROFF is stopped
+//		CICARUSGameInterface::TaskIDComplete(
+//			entitySystem->GetEntityFromID(roff_ent->mEntID), TID_MOVE);
+		// trash this guy from the list
+		delete roff_ent;
+		return true;
+	});
+	mROFFEntList.erase( killed, mROFFEntList.end() );
 }
 
 //---------------------------------------------------------------------------
@@ -858,7 +850,7 @@ void CROFFSystem::UpdateEntities(qboolean isClient)
 //---------------------------------------------------------------------------
 qboolean CROFFSystem::ApplyROFF( SROFFEntity *roff_ent, CROFFSystem::CROFF *roff )
 {
-	vec3_t			f, r, u, result;
+	vec3_t			result;
 	sharedEntity_t	*ent = NULL;
 	trajectory_t	*originTrajectory = NULL, *angleTrajectory = NULL;
 	float			*origin = NULL, *angle = NULL;
@@ -909,32 +901,30 @@ qboolean CROFFSystem::ApplyROFF( SROFFEntity *roff_ent, CROFFSystem::CROFF *roff
 		return qfalse;
 	}
 
+	TROFF2Entry const &frame = roff->mMoveRotateList[roff_ent->mROFFFrame];
+
 	if (roff_ent->mTranslated)
 	{
-		AngleVectors(roff_ent->mStartAngles, f, r, u );
-		VectorScale(f, roff->mMoveRotateList[roff_ent->mROFFFrame].mOriginOffset[0], result);
-		VectorMA(result, -roff->mMoveRotateList[roff_ent->mROFFFrame].mOriginOffset[1], r, result);
-		VectorMA(result, roff->mMoveRotateList[roff_ent->mROFFFrame].mOriginOffset[2], u, result);
+		VectorScale(roff_ent->mStartAxis[0], frame.mOriginOffset[0], result);
+		VectorMA(result, -frame.mOriginOffset[1], roff_ent->mStartAxis[1], result);
+		VectorMA(result, frame.mOriginOffset[2], roff_ent->mStartAxis[2], result);
 	}
 	else
 	{
-		VectorCopy(roff->mMoveRotateList[roff_ent->mROFFFrame].mOriginOffset, result);
+		VectorCopy(frame.mOriginOffset, result);
 	}
 
 	// Set up our origin interpolation
 	SetLerp( originTrajectory, TR_LINEAR, origin, result, svs.time, roff->mLerp );
 
 	// Set up our angle interpolation
-	SetLerp( angleTrajectory, TR_LINEAR, angle,
-				roff->mMoveRotateList[roff_ent->mROFFFrame].mRotateOffset, svs.time, roff->mLerp );
+	SetLerp( angleTrajectory, TR_LINEAR, angle, (float *)frame.mRotateOffset, svs.time, roff->mLerp );
 
-	if (roff->mMoveRotateList[roff_ent->mROFFFrame].mStartNote >= 0)
+	for(int i=0;frame.mStartNote >= 0 && i<frame.mNumNotes;i++)
 	{
-		int		i;
-
-		for(i=0;i<roff->mMoveRotateList[roff_ent->mROFFFrame].mNumNotes;i++)
+		for (std::string const &event : roff->mNoteEvents[frame.mStartNote + i])
 		{
-			ProcessNote(roff_ent, roff->mNoteTrackIndexes[roff->mMoveRotateList[roff_ent->mROFFFrame].mStartNote + i]);
+			ProcessNote(roff_ent, event.c_str());
 		}
 	}
 
@@ -952,51 +942,67 @@ qboolean CROFFSystem::ApplyROFF( SROFFEntity *roff_ent, CROFFSystem::CROFF *roff
 
 
 /************************************************************************************************
- * CROFFSystem::ProcessNote                                                                     *
- *    This function will send the note to the client.  It will parse through the note for       *
- *    leading or trailing white space (thus making each line feed a separate function call).    *
+ * CROFFSystem::SplitNote                                                                       *
+ *    This function will parse through the note for leading or trailing white space, thus       *
+ *    making each line feed a separate event.  Done once when the roff is cached.               *
  *                                                                                              *
  * Input                                                                                        *
- *    ent: the entity for which the roff is being played                                        *
- *    note: the note that should be passed on                                                   *
+ *    obj: the ROFF object                                                                      *
+ *    note: the note track to split                                                             *
  *                                                                                              *
  * Output / Return                                                                              *
  *    none                                                                                      *
  *                                                                                              *
  ************************************************************************************************/
-void CROFFSystem::ProcessNote(SROFFEntity *roff_ent, char *note)
+void CROFFSystem::SplitNote(CROFF *obj, const char *note)
 {
-	char	temp[1024];
-	int		pos, size;
+	std::vector<std::string> &events = obj->mNoteEvents.emplace_back();
+	int		pos, start;
 
 	pos = 0;
 	while(note[pos])
 	{
-		size = 0;
 		while(note[pos] && note[pos] < ' ')
 		{
 			pos++;
 		}
 
+		start = pos;
 		while(note[pos] && note[pos] >= ' ')
 		{
-			temp[size++] = note[pos++];
+			pos++;
 		}
-		temp[size] = 0;
 
-		if (size)
+		if (pos > start)
 		{
-			if (roff_ent->mIsClient)
-			{
+			events.emplace_back(note + start, pos - start);
+		}
+	}
+}
+
+/************************************************************************************************
+ * CROFFSystem::ProcessNote                                                                     *
+ *    This function will send a single note event to the client or game.                        *
+ *                                                                                              *
+ * Input                                                                                        *
+ *    ent: the entity for which the roff is being played                                        *
+ *    note: the note that should be passed on                                                   *
+ *                                                                                              *
+ * Output / Return                                                                              *
+ *    none                                                                                      *
+ *                                                                                              *
+ ************************************************************************************************/
+void CROFFSystem::ProcessNote(SROFFEntity *roff_ent, const char *note)
+{
+	if (roff_ent->mIsClient)
+	{
 #ifndef DEDICATED
-				CGVM_ROFF_NotetrackCallback( roff_ent->mEntID, temp );
+		CGVM_ROFF_NotetrackCallback( roff_ent->mEntID, note );
 #endif
-			}
-			else
-			{
-				GVM_ROFF_NotetrackCallback( roff_ent->mEntID, temp );
-			}
-		}
+	}
+	else
+	{
+		GVM_ROFF_NotetrackCallback( roff_ent->mEntID, note );
 	}
 }
 
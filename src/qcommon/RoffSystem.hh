@@ -27,6 +27,8 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 
 #include <vector>
 #include <map>
+#include <string>
+#include <unordered_map>
 
 // ROFF Defines
 //-------------------
@@ -55,6 +57,7 @@ private:
 	typedef std::vector	<SROFFEntity *> TROFFEntList;
 
 	TROFFList		mROFFList;				// List of cached roffs
+	std::unordered_map<std::string, int> mROFFIDLookup;	// roff file path -> id
 	int				mID;					// unique ID generator for new roff objects
 
 	TROFFEntList	mROFFEntList;			// List of roffing entities
@@ -113,7 +116,7 @@ private:
 		int			mLerp;						// Lerp rate (FPS)
 		TROFF2Entry	*mMoveRotateList;			// move rotate/command list
 		int			mNumNoteTracks;
-		char		**mNoteTrackIndexes;
+		std::vector<std::vector<std::string>> mNoteEvents;	// each note track split into its callback lines
 		qboolean	mUsedByClient;
 		qboolean	mUsedByServer;
 
@@ -137,6 +140,7 @@ private:
 		int			mEntID;			// the entity that is currently roffing
 
 		int			mROFFID;		// the roff to be applied to that entity
+		CROFF		*mROFF;			// cached mROFFList entry for mROFFID, NULL once unloaded
 		int			mNextROFFTime;	// next time we should roff
 		int			mROFFFrame;		// current roff frame we are applying
 
@@ -145,6 +149,7 @@ private:
 		qboolean	mTranslated;	// should this roff be "rotated" to fit the entity's initial position?
 		qboolean	mIsClient;
 		vec3_t		mStartAngles;	// initial angle of the entity
+		vec3_t		mStartAxis[3];	// forward/right/up of mStartAngles, for translated roffs
 	}; // struct SROFFEntity
 
 
@@ -156,7 +161,8 @@ private:
 	qboolean	ApplyROFF( SROFFEntity *roff_ent,
 					CROFFSystem::CROFF *roff );	// True = success; False = roff complete
 
-	void	ProcessNote(SROFFEntity *roff_ent, char *note);
+	void	SplitNote(CROFF *obj, const char *note);
+	void	ProcessNote(SROFFEntity *roff_ent, const char *note);
 
 	void	SetLerp( trajectory_t *tr,
 					trType_t, vec3_t origin,
@@ -23,6 +23,7 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 
 // cmodel.c -- model loading
 #include "cm_local.hh"
+#include "cm_patch.hh"
 #include "qcommon/qfiles.hh"
 
 #ifdef BSPC
@@ -54,7 +55,7 @@ void SetPlaneSignbits (cplane_t *out) {
 
 
 clipMap_t	cmg; //rwwRMG - changed from cm
-int			c_pointcontents;
+std::atomic_int	c_pointcontents;
 int			c_traces, c_brush_traces, c_patch_traces;
 
 
@@ -320,8 +321,15 @@ static void CMod_LoadLeafs (const lump_t *l, clipMap_t &cm)
 			cm.numAreas = out->area + 1;
 	}
 
+	if ( cm.numAreas > MAX_MAP_AREAS )
+		Com_Error (ERR_DROP, "CMod_LoadLeafs: MAX_MAP_AREAS exceeded");
+
 	cm.areas = (cArea_t *)Hunk_Alloc( cm.numAreas * sizeof( *cm.areas ), h_high );
 	cm.areaPortals = (int *)Hunk_Alloc( cm.numAreas * cm.numAreas * sizeof( *cm.areaPortals ), h_high );
+
+	cm.areaWords = ( cm.numAreas + 63 ) >> 6;
+	cm.areaAdjacency = (uint64_t *)Hunk_Alloc( cm.numAreas * cm.areaWords * sizeof( *cm.areaAdjacency ), h_high );
+	cm.areaFloodBits = (uint64_t *)Hunk_Alloc( ( cm.numAreas + 1 ) * cm.areaWords * sizeof( *cm.areaFloodBits ), h_high );
 }
 
 /*
@@ -516,13 +524,261 @@ static void CMod_LoadVisibility( const lump_t *l, clipMap_t &cm ) {
 //==================================================================
 
 
+/*
+===============================================================================
+
+PATCH COLLISION CACHE
+
+Generating the facets of every patch is the slowest part of loading a clip
+map, so the first load of a BSP writes them to "<map>.cmc" in the home path
+and later loads of the same BSP map that file instead.  It holds no pointers,
+every array is addressed by its offset from the start of the file, and the
+patchCollide_t headers on the hunk point straight into the read only
+mapping, so servers on one host running the same map share its pages.
+
+4	PATCH_CACHE_IDENT
+4	PATCH_CACHE_VERSION
+4	BSP checksum
+4	number of surfaces in the BSP
+4	number of cached patches
+4	sizeof( patchPlane_t )
+4	sizeof( facet_t )
+then a patchCacheEntry_t per patch, in surface order, followed by the
+planes, facets and points they refer to
+
+===============================================================================
+*/
+
+#ifndef BSPC
+
+#define	PATCH_CACHE_IDENT	(('H'<<24)+('C'<<16)+('M'<<8)+'C')
+#define	PATCH_CACHE_VERSION	1
+
+typedef struct patchCacheHeader_s {
+	int			ident;
+	int			version;
+	int			checksum;
+	int			numSurfaces;
+	int			numPatches;
+	int			planeSize;
+	int			facetSize;
+} patchCacheHeader_t;
+
+typedef struct patchCacheEntry_s {
+	int			surface;
+	vec3_t		bounds[2];
+	int			width, height;
+	int			numPlanes, numFacets;
+	int			planesOfs, facetsOfs, pointsOfs;
+} patchCacheEntry_t;
+
+cvar_t		*cm_patchCache;
+
+static void CM_PatchCacheName( const char *name, char *out, int outSize ) {
+	COM_StripExtension( name, out, outSize );
+	Q_strcat( out, outSize, ".cmc" );
+}
+
+static qboolean CM_PatchCacheRange( const clipMap_t &cm, int ofs, int count, size_t size ) {
+	return (qboolean)( ofs >= 0 && count >= 0 && (size_t)ofs + (size_t)count * size <= cm.patchCacheSize );
+}
+
+/*
+=================
+CM_ReleasePatchCache
+=================
+*/
+static void CM_ReleasePatchCache( clipMap_t &cm ) {
+	if ( cm.patchCache ) {
+		Sys_UnmapFile( cm.patchCache, cm.patchCacheSize );
+	}
+	cm.patchCache = NULL;
+	cm.patchCacheSize = 0;
+}
+
+/*
+=================
+CM_PatchCacheEntryValid
+
+Everything the trace code will index through, so a damaged file can't take the server down
+=================
+*/
+static qboolean CM_PatchCacheEntryValid( const clipMap_t &cm, const patchCacheEntry_t *entry ) {
+	if ( entry->width <= 0 || entry->width > MAX_GRID_SIZE || entry->height <= 0 || entry->height > MAX_GRID_SIZE ) {
+		return qfalse;
+	}
+	if ( !CM_PatchCacheRange( cm, entry->planesOfs, entry->numPlanes, sizeof( patchPlane_t ) )
+		|| !CM_PatchCacheRange( cm, entry->facetsOfs, entry->numFacets, sizeof( facet_t ) )
+		|| !CM_PatchCacheRange( cm, entry->pointsOfs, entry->width * entry->height, sizeof( vec3_t ) ) ) {
+		return qfalse;
+	}
+
+	const facet_t *facet = (const facet_t *)( (const byte *)cm.patchCache + entry->facetsOfs );
+	for ( int i = 0; i < entry->numFacets; i++, facet++ ) {
+		if ( facet->surfacePlane < 0 || facet->surfacePlane >= entry->numPlanes
+			|| facet->numBorders < 0 || facet->numBorders > (int)ARRAY_LEN( facet->borderPlanes ) ) {
+			return qfalse;
+		}
+		for ( int j = 0; j < facet->numBorders; j++ ) {
+			if ( facet->borderPlanes[j] < 0 || facet->borderPlanes[j] >= entry->numPlanes ) {
+				return qfalse;
+			}
+		}
+	}
+	return qtrue;
+}
+
+/*
+=================
+CM_LoadPatchCache
+
+Maps the cache written for this exact BSP, returning its entries or NULL if it is missing, stale or damaged
+=================
+*/
+static const patchCacheEntry_t *CM_LoadPatchCache( const char *name, int checksum, const dsurface_t *surfaces, int numSurfaces, clipMap_t &cm ) {
+	char	qpath[MAX_QPATH];
+	int		numPatches = 0;
+
+	for ( int i = 0; i < numSurfaces; i++ ) {
+		if ( LittleLong( surfaces[i].surfaceType ) == MST_PATCH ) {
+			numPatches++;
+		}
+	}
+	if ( !numPatches || !cm_patchCache->integer ) {
+		return NULL;
+	}
+
+	CM_PatchCacheName( name, qpath, sizeof( qpath ) );
+	cm.patchCache = Sys_MapFile( FS_BuildOSPath( Cvar_VariableString( "fs_homepath" ), FS_GetCurrentGameDir(), qpath ), &cm.patchCacheSize );
+	if ( !cm.patchCache ) {
+		return NULL;
+	}
+
+	const patchCacheHeader_t *header = (const patchCacheHeader_t *)cm.patchCache;
+	const patchCacheEntry_t *entries = (const patchCacheEntry_t *)( header + 1 );
+	qboolean valid = (qboolean)( cm.patchCacheSize >= sizeof( *header )
+		&& header->ident == PATCH_CACHE_IDENT
+		&& header->version == PATCH_CACHE_VERSION
+		&& header->checksum == checksum
+		&& header->numSurfaces == numSurfaces
+		&& header->numPatches == numPatches
+		&& header->planeSize == (int)sizeof( patchPlane_t )
+		&& header->facetSize == (int)sizeof( facet_t )
+		&& CM_PatchCacheRange( cm, sizeof( *header ), numPatches, sizeof( patchCacheEntry_t ) ) );
+
+	for ( int i = 0, surface = -1; valid && i < numPatches; i++ ) {
+		valid = (qboolean)( entries[i].surface > surface && entries[i].surface < numSurfaces
+			&& LittleLong( surfaces[entries[i].surface].surfaceType ) == MST_PATCH
+			&& CM_PatchCacheEntryValid( cm, &entries[i] ) );
+		surface = entries[i].surface;
+	}
+
+	if ( !valid ) {
+		Com_DPrintf( "CM_LoadPatchCache: %s is out of date\n", qpath );
+		CM_ReleasePatchCache( cm );
+		return NULL;
+	}
+	return entries;
+}
+
+/*
+=================
+CM_WritePatchCache
+
+Written to a temporary name and renamed into place, as other servers may be mapping or writing the same cache
+=================
+*/
+static void CM_WritePatchCache( const char *name, int checksum, const clipMap_t &cm ) {
+	patchCacheHeader_t	header;
+	patchCacheEntry_t	*entry;
+	char				qpath[MAX_QPATH], temp[MAX_QPATH];
+	int					numPatches = 0, size, ofs;
+	byte				*buf;
+
+	size = sizeof( header );
+	for ( int i = 0; i < cm.numSurfaces; i++ ) {
+		if ( !cm.surfaces[i] ) {
+			continue;
+		}
+		const patchCollide_t *pc = cm.surfaces[i]->pc;
+		size += sizeof( *entry ) + pc->numPlanes * sizeof( patchPlane_t ) + pc->numFacets * sizeof( facet_t )
+			+ pc->width * pc->height * sizeof( vec3_t );
+		numPatches++;
+	}
+	if ( !numPatches ) {
+		return;
+	}
+
+	header.ident = PATCH_CACHE_IDENT;
+	header.version = PATCH_CACHE_VERSION;
+	header.checksum = checksum;
+	header.numSurfaces = cm.numSurfaces;
+	header.numPatches = numPatches;
+	header.planeSize = sizeof( patchPlane_t );
+	header.facetSize = sizeof( facet_t );
+
+	buf = (byte *)Z_Malloc( size, TAG_TEMP_WORKSPACE, qfalse );
+	Com_Memcpy( buf, &header, sizeof( header ) );
+	entry = (patchCacheEntry_t *)( buf + sizeof( header ) );
+	ofs = sizeof( header ) + numPatches * sizeof( *entry );
+
+	for ( int i = 0; i < cm.numSurfaces; i++ ) {
+		if ( !cm.surfaces[i] ) {
+			continue;
+		}
+		const patchCollide_t *pc = cm.surfaces[i]->pc;
+		entry->surface = i;
+		VectorCopy( pc->bounds[0], entry->bounds[0] );
+		VectorCopy( pc->bounds[1], entry->bounds[1] );
+		entry->width = pc->width;
+		entry->height = pc->height;
+		entry->numPlanes = pc->numPlanes;
+		entry->numFacets = pc->numFacets;
+
+		entry->planesOfs = ofs;
+		Com_Memcpy( buf + ofs, pc->planes, pc->numPlanes * sizeof( patchPlane_t ) );
+		ofs += pc->numPlanes * sizeof( patchPlane_t );
+
+		entry->facetsOfs = ofs;
+		if ( pc->numFacets ) {
+			Com_Memcpy( buf + ofs, pc->facets, pc->numFacets * sizeof( facet_t ) );
+		}
+		ofs += pc->numFacets * sizeof( facet_t );
+
+		entry->pointsOfs = ofs;
+		Com_Memcpy( buf + ofs, pc->points, pc->width * pc->height * sizeof( vec3_t ) );
+		ofs += pc->width * pc->height * sizeof( vec3_t );
+
+		entry++;
+	}
+
+	CM_PatchCacheName( name, qpath, sizeof( qpath ) );
+	Com_sprintf( temp, sizeof( temp ), "%s.%x", qpath, Sys_Milliseconds() );
+
+	fileHandle_t f = FS_FOpenFileWrite( temp );
+	if ( f ) {
+		const int written = FS_Write( buf, size, f );
+		FS_FCloseFile( f );
+		if ( written == size ) {
+			FS_Rename( temp, qpath );
+			Com_DPrintf( "CM_WritePatchCache: wrote %d patches to %s\n", numPatches, qpath );
+		} else {
+			FS_HomeRemove( temp );
+		}
+	}
+
+	Z_Free( buf );
+}
+
+#endif
+
 /*
 =================
 CMod_LoadPatches
 =================
 */
 #define	MAX_PATCH_VERTS		1024
-static void CMod_LoadPatches( const lump_t *surfs, const lump_t *verts, clipMap_t &cm ) {
+static void CMod_LoadPatches( const lump_t *surfs, const lump_t *verts, clipMap_t &cm, const char *name, int checksum ) {
 	drawVert_t	*dv, *dv_p;
 	dsurface_t	*in;
 	int			count;
@@ -543,6 +799,10 @@ static void CMod_LoadPatches( const lump_t *surfs, const lump_t *verts, clipMap_
 	if (verts->filelen % sizeof(*dv))
 		Com_Error (ERR_DROP, "MOD_LoadBmodel: funny lump size");
 
+#ifndef BSPC
+	const patchCacheEntry_t *cached = CM_LoadPatchCache( name, checksum, in, count, cm );
+#endif
+
 	// scan through all the surfaces, but only load patches,
 	// not planar faces
 	for ( i = 0 ; i < count ; i++, in++ ) {
@@ -553,6 +813,30 @@ static void CMod_LoadPatches( const lump_t *surfs, const lump_t *verts, clipMap_
 
 		cm.surfaces[ i ] = patch = (cPatch_t *)Hunk_Alloc( sizeof( *patch ), h_high );
 
+		shaderNum = LittleLong( in->shaderNum );
+		patch->contents = cm.shaders[shaderNum].contentFlags;
+		patch->surfaceFlags = cm.shaders[shaderNum].surfaceFlags;
+
+#ifndef BSPC
+		if ( cached ) {
+			// the arrays stay in the read only mapping
+			const byte *base = (const byte *)cm.patchCache;
+			patchCollide_t *pc = (patchCollide_t *)Hunk_Alloc( sizeof( *pc ), h_high );
+			VectorCopy( cached->bounds[0], pc->bounds[0] );
+			VectorCopy( cached->bounds[1], pc->bounds[1] );
+			pc->width = cached->width;
+			pc->height = cached->height;
+			pc->numPlanes = cached->numPlanes;
+			pc->planes = (patchPlane_t *)( base + cached->planesOfs );
+			pc->numFacets = cached->numFacets;
+			pc->facets = cached->numFacets ? (facet_t *)( base + cached->facetsOfs ) : NULL;
+			pc->points = (vec3_t *)( base + cached->pointsOfs );
+			patch->pc = pc;
+			cached++;
+			continue;
+		}
+#endif
+
 		// load the full drawverts onto the stack
 		width = LittleLong( in->patchWidth );
 		height = LittleLong( in->patchHeight );
@@ -568,13 +852,15 @@ static void CMod_LoadPatches( const lump_t *surfs, const lump_t *verts, clipMap_
 			points[j][2] = LittleFloat( dv_p->xyz[2] );
 		}
 
-		shaderNum = LittleLong( in->shaderNum );
-		patch->contents = cm.shaders[shaderNum].contentFlags;
-		patch->surfaceFlags = cm.shaders[shaderNum].surfaceFlags;
-
 		// create the internal facet structure
 		patch->pc = CM_GeneratePatchCollide( width, height, points );
 	}
+
+#ifndef BSPC
+	if ( !cm.patchCache && cm_patchCache->integer ) {
+		CM_WritePatchCache( name, checksum, cm );
+	}
+#endif
 }
 
 //==================================================================
@@ -640,6 +926,7 @@ static void CM_LoadMap_Actual( const char *name, qboolean clientload, int *check
 	cm_noCurves = Cvar_Get ("cm_noCurves", "0", CVAR_CHEAT);
 	cm_playerCurveClip = Cvar_Get ("cm_playerCurveClip", "1", CVAR_ARCHIVE_ND|CVAR_CHEAT );
 	cm_extraVerbose = Cvar_Get ("cm_extraVerbose", "0", CVAR_TEMP );
+	cm_patchCache = Cvar_Get ("cm_patchCache", "1", CVAR_ARCHIVE_ND );
 #endif
 	Com_DPrintf( "CM_LoadMap( %s, %i )\n", name, clientload );
 
@@ -659,6 +946,9 @@ static void CM_LoadMap_Actual( const char *name, qboolean clientload, int *check
 	}
 
 	// free old stuff
+#ifndef BSPC
+	CM_ReleasePatchCache( cm );
+#endif
 	Com_Memset( &cm, 0, sizeof( cm ) );
 
 	if ( !name[0] ) {
@@ -746,7 +1036,7 @@ static void CM_LoadMap_Actual( const char *name, qboolean clientload, int *check
 	CMod_LoadNodes (&header.lumps[LUMP_NODES], cm);
 	CMod_LoadEntityString (&header.lumps[LUMP_ENTITIES], cm, name);
 	CMod_LoadVisibility( &header.lumps[LUMP_VISIBILITY], cm );
-	CMod_LoadPatches( &header.lumps[LUMP_SURFACES], &header.lumps[LUMP_DRAWVERTS], cm );
+	CMod_LoadPatches( &header.lumps[LUMP_SURFACES], &header.lumps[LUMP_DRAWVERTS], cm, name, last_checksum );
 
 	TotalSubModels += cm.numSubModels;
 
@@ -810,11 +1100,17 @@ void CM_ClearMap( void )
 {
 	int		i;
 
+#ifndef BSPC
+	CM_ReleasePatchCache( cmg );
+#endif
 	Com_Memset( &cmg, 0, sizeof( cmg ) );
 	CM_ClearLevelPatches();
 
 	for(i = 0; i < NumSubBSP; i++)
 	{
+#ifndef BSPC
+		CM_ReleasePatchCache( SubBSP[i] );
+#endif
 		memset(&SubBSP[i], 0, sizeof(SubBSP[0]));
 	}
 	NumSubBSP = 0;
@@ -28,6 +28,8 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "qcommon/qcommon.hh"
 #include "qcommon/q_math2.hh"
 
+#include <atomic>
+
 #define	MAX_SUBMODELS			512
 #define	BOX_MODEL_HANDLE		(MAX_SUBMODELS-1)
 #define CAPSULE_MODEL_HANDLE	(MAX_SUBMODELS-2)
@@ -42,12 +44,13 @@ struct Point
 #define	SURFACE_CLIP_EPSILON	(0.125)
 
 extern	clipMap_t	cmg; //rwwRMG - changed from cm
-extern	int			c_pointcontents;
+extern	std::atomic_int	c_pointcontents;	// also bumped by game code reading the pvs off the main thread
 extern	int			c_traces, c_brush_traces, c_patch_traces;
 extern	cvar_t		*cm_noAreas;
 extern	cvar_t		*cm_noCurves;
 extern	cvar_t		*cm_playerCurveClip;
 extern	cvar_t		*cm_extraVerbose;
+extern	cvar_t		*cm_patchCache;
 
 // cm_test.c
 
@@ -157,12 +157,18 @@ typedef struct clipMap_s {
 	int			numAreas;
 	cArea_t		*areas;
 	int			*areaPortals;	// [ numAreas*numAreas ] reference counts
+	int			areaWords;		// uint64_t words in one row of area bits
+	uint64_t	*areaAdjacency;	// [ numAreas*areaWords ] areas each area has an open portal to
+	uint64_t	*areaFloodBits;	// [ (numAreas+1)*areaWords ] areas in each flood, indexed by floodnum
 
 	int			numSurfaces;
 	cPatch_t	**surfaces;			// non-patches will be NULL
 
 	int			floodvalid;
 	int			checkcount;					// incremented on each trace
+
+	void		*patchCache;				// mapped patch collision cache, see CM_LoadPatchCache
+	size_t		patchCacheSize;
 } clipMap_t;
 
 clipMap_t const * CM_Get();
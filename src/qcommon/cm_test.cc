@@ -23,6 +23,8 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 
 #include "cm_local.hh"
 
+#include <bit>
+
 /*
 ==================
 CM_PointLeafnum_r
@@ -49,7 +51,7 @@ int CM_PointLeafnum_r( const vec3_t p, int num, clipMap_t *local ) {
 			num = node->children[0];
 	}
 
-	c_pointcontents++;		// optimize counter
+	c_pointcontents.fetch_add( 1, std::memory_order_relaxed );		// optimize counter
 
 	return -1 - num;
 }
@@ -316,25 +318,52 @@ AREAPORTALS
 
 ===============================================================================
 */
-void CM_FloodArea_r( int areaNum, int floodnum, clipMap_t &cm ) {
-	int		i;
-	cArea_t *area;
-	int		*con;
+#define	MAX_AREA_WORDS	( ( MAX_MAP_AREAS + 63 ) >> 6 )
 
-	area = &cm.areas[ areaNum ];
+/*
+====================
+CM_AreaReach
 
-	if ( area->floodvalid == cm.floodvalid ) {
-		if (area->floodnum == floodnum)
-			return;
-		Com_Error (ERR_DROP, "FloodArea_r: reflooded");
-	}
+Fills reached with every area that can be reached from areaNum through open
+portals, a whole frontier of areas per pass over the adjacency rows
+====================
+*/
+static void CM_AreaReach( const clipMap_t &cm, int areaNum, uint64_t *reached ) {
+	uint64_t	frontier[MAX_AREA_WORDS], next[MAX_AREA_WORDS];
+	const int	words = cm.areaWords;
+	uint64_t	grew;
+
+	Com_Memset( reached, 0, words * sizeof( *reached ) );
+	reached[areaNum >> 6] = 1ull << ( areaNum & 63 );
+	Com_Memcpy( frontier, reached, words * sizeof( *frontier ) );
+
+	do {
+		Com_Memset( next, 0, words * sizeof( *next ) );
+		for ( int w = 0; w < words; w++ ) {
+			for ( uint64_t bits = frontier[w]; bits; bits &= bits - 1 ) {
+				const uint64_t *row = cm.areaAdjacency + ( ( w << 6 ) + std::countr_zero( bits ) ) * words;
+				for ( int k = 0; k < words; k++ ) {
+					next[k] |= row[k];
+				}
+			}
+		}
 
-	area->floodnum = floodnum;
-	area->floodvalid = cm.floodvalid;
-	con = cm.areaPortals + areaNum * cm.numAreas;
-	for ( i=0 ; i < cm.numAreas  ; i++ ) {
-		if ( con[i] > 0 ) {
-			CM_FloodArea_r( i, floodnum, cm );
+		grew = 0;
+		for ( int k = 0; k < words; k++ ) {
+			frontier[k] = next[k] & ~reached[k];
+			reached[k] |= frontier[k];
+			grew |= frontier[k];
+		}
+	} while ( grew );
+}
+
+// gives every area in the row of flood bits the flood number
+static void CM_SetAreaFlood( clipMap_t &cm, const uint64_t *areas, int floodnum ) {
+	for ( int w = 0; w < cm.areaWords; w++ ) {
+		for ( uint64_t bits = areas[w]; bits; bits &= bits - 1 ) {
+			cArea_t *area = &cm.areas[( w << 6 ) + std::countr_zero( bits )];
+			area->floodnum = floodnum;
+			area->floodvalid = cm.floodvalid;
 		}
 	}
 }
@@ -343,32 +372,48 @@ void CM_FloodArea_r( int areaNum, int floodnum, clipMap_t &cm ) {
 ====================
 CM_FloodAreaConnections
 
+Rebuilds the adjacency rows from the portal reference counts and refloods every area
 ====================
 */
 void	CM_FloodAreaConnections( clipMap_t &cm ) {
-	int		i;
-	cArea_t	*area;
+	int		i, j;
 	int		floodnum;
+	const int words = cm.areaWords;
+
+	Com_Memset( cm.areaAdjacency, 0, cm.numAreas * words * sizeof( *cm.areaAdjacency ) );
+	for ( i = 0 ; i < cm.numAreas ; i++ ) {
+		const int *con = cm.areaPortals + i * cm.numAreas;
+		for ( j = 0 ; j < cm.numAreas ; j++ ) {
+			if ( con[j] > 0 ) {
+				cm.areaAdjacency[i * words + ( j >> 6 )] |= 1ull << ( j & 63 );
+			}
+		}
+	}
 
 	// all current floods are now invalid
 	cm.floodvalid++;
 	floodnum = 0;
+	Com_Memset( cm.areaFloodBits, 0, ( cm.numAreas + 1 ) * words * sizeof( *cm.areaFloodBits ) );
 
 	for (i = 0 ; i < cm.numAreas ; i++) {
-		area = &cm.areas[i];
-		if (area->floodvalid == cm.floodvalid) {
+		if (cm.areas[i].floodvalid == cm.floodvalid) {
 			continue;		// already flooded into
 		}
 		floodnum++;
-		CM_FloodArea_r (i, floodnum, cm);
+		uint64_t *flood = cm.areaFloodBits + floodnum * words;
+		CM_AreaReach( cm, i, flood );
+		CM_SetAreaFlood( cm, flood, floodnum );
 	}
-
 }
 
 /*
 ====================
 CM_AdjustAreaPortalState
 
+Only a portal opening or closing for the first or last reference changes the
+floods, and then only the floods of the two areas: an opening merges them, a
+closing refloods from one side and splits off whatever can no longer reach
+the other
 ====================
 */
 void	CM_AdjustAreaPortalState( int area1, int area2, qboolean open ) {
@@ -380,6 +425,8 @@ void	CM_AdjustAreaPortalState( int area1, int area2, qboolean open ) {
 		Com_Error (ERR_DROP, "CM_ChangeAreaPortalState: bad area number");
 	}
 
+	const qboolean wasOpen = (qboolean)( cmg.areaPortals[ area1 * cmg.numAreas + area2 ] > 0 );
+
 	if ( open ) {
 		cmg.areaPortals[ area1 * cmg.numAreas + area2 ]++;
 		cmg.areaPortals[ area2 * cmg.numAreas + area1 ]++;
@@ -391,7 +438,60 @@ void	CM_AdjustAreaPortalState( int area1, int area2, qboolean open ) {
 		}
 	}
 
-	CM_FloodAreaConnections (cmg);
+	const qboolean isOpen = (qboolean)( cmg.areaPortals[ area1 * cmg.numAreas + area2 ] > 0 );
+	if ( wasOpen == isOpen || area1 == area2 ) {
+		return;
+	}
+
+	const int words = cmg.areaWords;
+	uint64_t *adjacency1 = cmg.areaAdjacency + area1 * words;
+	uint64_t *adjacency2 = cmg.areaAdjacency + area2 * words;
+	const int flood1 = cmg.areas[area1].floodnum;
+	const int flood2 = cmg.areas[area2].floodnum;
+	uint64_t *bits1 = cmg.areaFloodBits + flood1 * words;
+
+	if ( isOpen ) {
+		adjacency1[area2 >> 6] |= 1ull << ( area2 & 63 );
+		adjacency2[area1 >> 6] |= 1ull << ( area1 & 63 );
+
+		if ( flood1 != flood2 ) {
+			uint64_t *bits2 = cmg.areaFloodBits + flood2 * words;
+			CM_SetAreaFlood( cmg, bits2, flood1 );
+			for ( int k = 0; k < words; k++ ) {
+				bits1[k] |= bits2[k];
+				bits2[k] = 0;
+			}
+		}
+		return;
+	}
+
+	adjacency1[area2 >> 6] &= ~( 1ull << ( area2 & 63 ) );
+	adjacency2[area1 >> 6] &= ~( 1ull << ( area1 & 63 ) );
+
+	uint64_t reached[MAX_AREA_WORDS];
+	CM_AreaReach( cmg, area1, reached );
+	if ( reached[area2 >> 6] & ( 1ull << ( area2 & 63 ) ) ) {
+		return;		// still connected some other way
+	}
+
+	// there are never more floods than areas, so a split always finds an unused floodnum
+	int floodnum;
+	for ( floodnum = 1 ; floodnum <= cmg.numAreas ; floodnum++ ) {
+		const uint64_t *bits = cmg.areaFloodBits + floodnum * words;
+		int k;
+		for ( k = 0 ; k < words && !bits[k] ; k++ ) {
+		}
+		if ( k == words ) {
+			break;
+		}
+	}
+
+	uint64_t *split = cmg.areaFloodBits + floodnum * words;
+	for ( int k = 0; k < words; k++ ) {
+		split[k] = reached[k];
+		bits1[k] &= ~reached[k];
+	}
+	CM_SetAreaFlood( cmg, split, floodnum );
 }
 
 /*
@@ -439,7 +539,6 @@ This is used to cull non-visible entities from snapshots
 int CM_WriteAreaBits (byte *buffer, int area)
 {
 	int		i;
-	int		floodnum;
 	int		bytes;
 
 	bytes = (cmg.numAreas+7)>>3;
@@ -453,12 +552,11 @@ int CM_WriteAreaBits (byte *buffer, int area)
 		Com_Memset (buffer, 255, bytes);
 	}
 	else
-	{
-		floodnum = cmg.areas[area].floodnum;
-		for (i=0 ; i<cmg.numAreas ; i++)
+	{	// the flood's area bits are kept up to date by CM_AdjustAreaPortalState
+		const uint64_t *flood = cmg.areaFloodBits + cmg.areas[area].floodnum * cmg.areaWords;
+		for (i=0 ; i<bytes ; i++)
 		{
-			if (cmg.areas[i].floodnum == floodnum || area == -1)
-				buffer[i>>3] |= 1<<(i&7);
+			buffer[i] |= (byte)( flood[i>>3] >> ( ( i&7 ) << 3 ) );
 		}
 	}
 
@@ -356,6 +356,7 @@ static	char		cmd_tokenized[BIG_INFO_STRING+MAX_STRING_TOKENS];	// will have 0 by
 static	char		cmd_cmd[BIG_INFO_STRING]; // the original command we received (no token processing)
 
 static	cmd_function_t	*cmd_functions;		// possible commands to execute
+static	std::unordered_map<istring_view, cmd_function_t *, istring_hash, std::equal_to<>> cmd_lookup; // keyed on cmd->name
 
 
 /*
@@ -639,11 +640,8 @@ Cmd_FindCommand
 */
 cmd_function_t *Cmd_FindCommand( const char *cmd_name )
 {
-	cmd_function_t *cmd;
-	for( cmd = cmd_functions; cmd; cmd = cmd->next )
-		if( !Q_stricmp( cmd_name, cmd->name ) )
-			return cmd;
-	return NULL;
+	auto iter = cmd_lookup.find( istring_view { cmd_name } );
+	return (iter == cmd_lookup.end()) ? nullptr : iter->second;
 }
 
 /*
@@ -675,6 +673,7 @@ void	Cmd_AddCommand( const char *cmd_name, xcommand_t function, const char *cmd_
 	cmd->complete = NULL;
 	cmd->next = cmd_functions;
 	cmd_functions = cmd;
+	cmd_lookup.emplace( cmd->name, cmd );
 }
 
 void Cmd_AddCommandList( const cmdList_t *cmdList )
@@ -701,10 +700,9 @@ Cmd_SetCommandCompletionFunc
 ============
 */
 void Cmd_SetCommandCompletionFunc( const char *command, completionFunc_t complete ) {
-	for ( cmd_function_t *cmd=cmd_functions; cmd; cmd=cmd->next ) {
-		if ( !Q_stricmp( command, cmd->name ) )
-			cmd->complete = complete;
-	}
+	cmd_function_t *cmd = Cmd_FindCommand( command );
+	if ( cmd )
+		cmd->complete = complete;
 }
 
 /*
@@ -724,6 +722,7 @@ void	Cmd_RemoveCommand( const char *cmd_name ) {
 		}
 		if ( !strcmp( cmd_name, cmd->name ) ) {
 			*back = cmd->next;
+			cmd_lookup.erase( istring_view { cmd->name } );
 			Z_Free(cmd->name);
 			Z_Free(cmd->description);
 			Z_Free (cmd);
@@ -806,10 +805,9 @@ Cmd_CompleteArgument
 ============
 */
 void Cmd_CompleteArgument( const char *command, char *args, int argNum ) {
-	for ( cmd_function_t *cmd=cmd_functions; cmd; cmd=cmd->next ) {
-		if ( !Q_stricmp( command, cmd->name ) && cmd->complete )
-			cmd->complete( args, argNum );
-	}
+	cmd_function_t *cmd = Cmd_FindCommand( command );
+	if ( cmd && cmd->complete )
+		cmd->complete( args, argNum );
 }
 
 /*
@@ -820,7 +818,7 @@ A complete command line has been parsed, so try to execute it
 ============
 */
 void	Cmd_ExecuteString( const char *text ) {
-	cmd_function_t	*cmd, **prev;
+	cmd_function_t	*cmd;
 
 	// execute the command line
 	Cmd_TokenizeString( text );
@@ -829,25 +827,13 @@ void	Cmd_ExecuteString( const char *text ) {
 	}
 
 	// check registered command functions
-	for ( prev = &cmd_functions ; *prev ; prev = &cmd->next ) {
-		cmd = *prev;
-		if ( !Q_stricmp( Cmd_Argv(0), cmd->name ) ) {
-			// rearrange the links so that the command will be
-			// near the head of the list next time it is used
-			*prev = cmd->next;
-			cmd->next = cmd_functions;
-			cmd_functions = cmd;
-
-			// perform the action
-			if ( !cmd->function ) {
-				// let the cgame or game handle it
-				break;
-			} else {
-				cmd->function ();
-			}
-			return;
-		}
+	cmd = Cmd_FindCommand( Cmd_Argv(0) );
+	if ( cmd && cmd->function ) {
+		// perform the action
+		cmd->function ();
+		return;
 	}
+	// otherwise let the cgame or game handle it
 
 	// check cvars
 	if ( Cvar_Command() ) {
@@ -29,6 +29,10 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "qcommon/game_version.hh"
 #include "../server/NPCNav/navigator.hh"
 #include "sys/sys_local.hh"
+
+#include <atomic>
+#include <chrono>
+
 #if defined(_WIN32)
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
@@ -67,6 +71,7 @@ cvar_t	*com_cameraMode;
 cvar_t	*com_ansiColor = NULL;
 #endif
 cvar_t	*com_busyWait;
+cvar_t	*com_framePacing;
 
 // com_speeds times
 int		time_game;
@@ -82,6 +87,7 @@ qboolean	com_fullyInitialized = qfalse;
 char	com_errorMessage[MAXPRINTMSG] = {0};
 
 void Com_WriteConfig_f( void );
+static void Com_FrameStats_f( void );
 
 std::unique_ptr<TaskCore> com_taskcore;
 
@@ -1190,6 +1196,7 @@ void Com_Init( char *commandLine ) {
 		Cmd_AddCommand ("changeVectors", MSG_ReportChangeVectors_f );
 #endif
 		Cmd_AddCommand ("writeconfig", Com_WriteConfig_f, "Write the configuration to file" );
+		Cmd_AddCommand ("sv_frameStats", Com_FrameStats_f, "Show dedicated server frame pacing statistics" );
 		Cmd_SetCommandCompletionFunc( "writeconfig", Cmd_CompleteCfgName );
 
 		Com_ExecuteCfg();
@@ -1247,6 +1254,7 @@ void Com_Init( char *commandLine ) {
 #endif
 
 		com_busyWait = Cvar_Get( "com_busyWait", "0", CVAR_ARCHIVE_ND );
+		com_framePacing = Cvar_Get( "com_framePacing", "1", CVAR_ARCHIVE_ND, "Schedule dedicated server frames on a precise monotonic timeline" );
 
 		s = va("%s %s %s", JK_VERSION_OLD, PLATFORM_STRING, SOURCE_DATE );
 		com_version = Cvar_Get ("version", s, CVAR_ROM | CVAR_SERVERINFO );
@@ -1450,6 +1458,144 @@ int Com_TimeVal(int minMsec)
 	return timeVal;
 }
 
+/*
+=================
+Com_PaceServerFrame
+
+Dedicated server frame scheduler.  Frames sit on a fixed monotonic timeline
+one server frame apart.  The wait sleeps in select() so packets are still
+handled the moment they arrive, then polls the socket through a short spin
+tail sized from how late recent sleeps woke up.  Returns the milliseconds
+to simulate, carrying the sub-millisecond remainder to the next frame.
+=================
+*/
+#define PACING_BUCKETS 8
+
+static const int pacingBucketUsec[PACING_BUCKETS - 1] = { 50, 100, 250, 500, 1000, 2000, 5000 };
+
+static struct {
+	int64_t		nextFrameUsec;
+	int64_t		lastFrameUsec;
+	int			periodUsec;
+	int			carryUsec;
+	int			oversleepUsec;		// running average of how late select() wakes
+	int			spinUsec;
+
+	int			frames;
+	int			overruns;
+	int			maxLateUsec;
+	int64_t		totalLateUsec;
+	int			late[PACING_BUCKETS];
+	int			jitter[PACING_BUCKETS];
+} pacing;
+
+static int64_t Com_MonotonicUsec( void ) {
+	return std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+static int Com_PacingBucket( int usec ) {
+	int i;
+
+	for ( i = 0; i < PACING_BUCKETS - 1; i++ ) {
+		if ( usec < pacingBucketUsec[i] ) {
+			break;
+		}
+	}
+	return i;
+}
+
+static qboolean Com_FramePacingActive( void ) {
+	return ( com_dedicated->integer && com_framePacing->integer && com_sv_running->integer
+		&& !com_timedemo->integer && !com_busyWait->integer && com_timescale->value == 1.0f ) ? qtrue : qfalse;
+}
+
+static int Com_PaceServerFrame( void ) {
+	const int periodUsec = SV_FramePeriodMsec() * 1000;
+	int64_t now = Com_MonotonicUsec();
+	int64_t remaining, slept;
+	int request, late, interval, msec;
+
+	// first frame, or sv_fps changed: start a new timeline
+	if ( !pacing.nextFrameUsec || periodUsec != pacing.periodUsec ) {
+		pacing.periodUsec = periodUsec;
+		pacing.nextFrameUsec = now + periodUsec;
+		pacing.lastFrameUsec = now;
+		pacing.carryUsec = 0;
+		if ( !pacing.spinUsec ) {
+			pacing.oversleepUsec = 200;
+			pacing.spinUsec = 500;
+		}
+	}
+
+	// the last frame ran past a whole period, don't try to catch up the missed slots
+	if ( now - pacing.nextFrameUsec >= periodUsec ) {
+		pacing.overruns++;
+		pacing.nextFrameUsec = now;
+	}
+
+	while ( ( remaining = pacing.nextFrameUsec - now ) > 0 ) {
+		if ( remaining > pacing.spinUsec ) {
+			request = (int)( remaining - pacing.spinUsec );
+			NET_SleepUsec( request );
+			slept = Com_MonotonicUsec() - now;
+
+			// a packet may have woken us early, only learn from full sleeps
+			if ( slept >= request ) {
+				pacing.oversleepUsec += ( (int)( slept - request ) - pacing.oversleepUsec ) / 8;
+				pacing.spinUsec = Com_Clampi( 100, 2000, pacing.oversleepUsec * 2 + 100 );
+			}
+		} else {
+			NET_SleepUsec( 0 );
+		}
+		now = Com_MonotonicUsec();
+	}
+
+	late = (int)( now - pacing.nextFrameUsec );
+	interval = (int)( now - pacing.lastFrameUsec );
+
+	pacing.frames++;
+	pacing.totalLateUsec += late;
+	pacing.maxLateUsec = Q_max( pacing.maxLateUsec, late );
+	pacing.late[Com_PacingBucket( late )]++;
+	pacing.jitter[Com_PacingBucket( abs( interval - periodUsec ) )]++;
+
+	pacing.lastFrameUsec = now;
+	pacing.nextFrameUsec += periodUsec;
+
+	msec = ( interval + pacing.carryUsec ) / 1000;
+	pacing.carryUsec = ( interval + pacing.carryUsec ) % 1000;
+	return msec;
+}
+
+static void Com_PrintPacingHistogram( const char *label, const int *buckets ) {
+	Com_Printf( "%s\n", label );
+	for ( int i = 0; i < PACING_BUCKETS; i++ ) {
+		const char *range = ( i < PACING_BUCKETS - 1 ) ? va( "< %5d usec", pacingBucketUsec[i] ) : va( ">= %4d usec", pacingBucketUsec[i - 1] );
+		Com_Printf( "  %s: %8d (%5.1f%%)\n", range, buckets[i], pacing.frames ? 100.0f * buckets[i] / pacing.frames : 0.0f );
+	}
+}
+
+static void Com_FrameStats_f( void ) {
+	if ( Cmd_Argc() == 2 && !Q_stricmp( Cmd_Argv( 1 ), "reset" ) ) {
+		const int spinUsec = pacing.spinUsec, oversleepUsec = pacing.oversleepUsec;
+		Com_Memset( &pacing, 0, sizeof( pacing ) );
+		pacing.spinUsec = spinUsec;
+		pacing.oversleepUsec = oversleepUsec;
+		return;
+	}
+
+	if ( !Com_FramePacingActive() ) {
+		Com_Printf( "Frame pacing is only used by a running dedicated server with com_framePacing 1.\n" );
+	}
+
+	Com_Printf( "period %d usec, spin tail %d usec, %d frames, %d overruns\n",
+		pacing.periodUsec, pacing.spinUsec, pacing.frames, pacing.overruns );
+	Com_Printf( "wake late: avg %d usec, max %d usec\n",
+		pacing.frames ? (int)( pacing.totalLateUsec / pacing.frames ) : 0, pacing.maxLateUsec );
+	Com_PrintPacingHistogram( "wake late histogram:", pacing.late );
+	Com_PrintPacingHistogram( "frame interval jitter histogram:", pacing.jitter );
+}
+
 /*
 =================
 Com_Frame
@@ -1462,7 +1608,7 @@ void Com_Frame( void ) {
 #ifdef G2_PERFORMANCE_ANALYSIS
 		G2PerformanceTimer_PreciseFrame.Start();
 #endif
-		int		msec, minMsec;
+		int		msec, minMsec, pacedMsec = 0;
 		int		timeVal;
 		static int	lastTime = 0, bias = 0;
 
@@ -1512,20 +1658,27 @@ void Com_Frame( void ) {
 		else
 			minMsec = 1;
 
-		timeVal = Com_TimeVal(minMsec);
-		do {
-			// Busy sleep the last millisecond for better timeout precision
-			if(com_busyWait->integer || timeVal < 1)
-				NET_Sleep(0);
-			else
-				NET_Sleep(timeVal - 1);
-		} while( (timeVal = Com_TimeVal(minMsec)) != 0 );
+		const qboolean paced = Com_FramePacingActive();
+		if ( paced ) {
+			pacedMsec = Com_PaceServerFrame();
+		} else {
+			pacing.nextFrameUsec = 0;
+
+			timeVal = Com_TimeVal(minMsec);
+			do {
+				// Busy sleep the last millisecond for better timeout precision
+				if(com_busyWait->integer || timeVal < 1)
+					NET_Sleep(0);
+				else
+					NET_Sleep(timeVal - 1);
+			} while( (timeVal = Com_TimeVal(minMsec)) != 0 );
+		}
 		IN_Frame();
 
 		lastTime = com_frameTime;
 		com_frameTime = Com_EventLoop();
 
-		msec = com_frameTime - lastTime;
+		msec = paced ? pacedMsec : com_frameTime - lastTime;
 
 		Cbuf_Execute ();
 
@@ -1616,10 +1769,10 @@ void Com_Frame( void ) {
 		if ( com_showtrace->integer ) {
 
 			extern	int c_traces, c_brush_traces, c_patch_traces;
-			extern	int	c_pointcontents;
+			extern	std::atomic_int	c_pointcontents;
 
 			Com_Printf ("%4i traces  (%ib %ip) %4i points\n", c_traces,
-				c_brush_traces, c_patch_traces, c_pointcontents);
+				c_brush_traces, c_patch_traces, c_pointcontents.load());
 			c_traces = 0;
 			c_brush_traces = 0;
 			c_patch_traces = 0;
@@ -30,9 +30,19 @@ cvar_t		*cvar_vars = NULL;
 cvar_t		*cvar_cheats;
 uint32_t	cvar_modifiedFlags;
 
-static int cvar_handle_inc = 0;
-static std::unordered_map<istring, std::unique_ptr<cvar_t>> cvars;
-static std::unordered_map<qhandle_t, cvar_t *> cvar_handle_lookup;
+static istring_map<std::unique_ptr<cvar_t>> cvars;
+static std::vector<cvar_t *> cvar_handles; // indexed by cvar->handle, never reused
+
+// handles of changed cvars in modification order, so modules can pick up
+// just what changed instead of polling every vmCvar_t each frame
+#define MAX_CVAR_CHANGEFEED	1024
+static std::vector<cvarHandle_t> cvar_changeFeed;
+static int cvar_changeFeedBase = 0; // change sequence of cvar_changeFeed[0]
+
+// info strings are cached and patched from the change feed; anything that adds
+// or removes a cvar from an info string bumps the generation to force a rebuild
+#define MAX_CVAR_INFOCACHES	4
+static int cvar_infoGeneration = 0;
 
 #define FILE_HASH_SIZE		512
 
@@ -76,10 +86,48 @@ Cvar_FindVar
 ============
 */
 static cvar_t *Cvar_FindVar( const char *var_name ) {
-	auto iter = cvars.find(var_name);
+	auto iter = cvars.find( istring_view { var_name } );
 	return (iter == cvars.end()) ? nullptr : iter->second.get();
 }
 
+/*
+============
+Cvar_MarkModified
+============
+*/
+static void Cvar_MarkModified( cvar_t *var ) {
+	var->modified = qtrue;
+	var->modificationCount++;
+
+	if ( cvar_changeFeed.size() >= MAX_CVAR_CHANGEFEED ) {
+		// anyone this far behind has to resync by polling everything
+		cvar_changeFeedBase += cvar_changeFeed.size();
+		cvar_changeFeed.clear();
+	}
+	cvar_changeFeed.push_back( var->handle );
+}
+
+/*
+============
+Cvar_ChangeFeed
+
+Copies the handles of cvars modified since *sequence and advances it.
+Returns -1 if the caller must poll all of its cvars instead, either because
+it has never synced or because more changes happened than fit in handles.
+============
+*/
+int Cvar_ChangeFeed( int *sequence, cvarHandle_t *handles, int maxHandles ) {
+	const int head = cvar_changeFeedBase + (int)cvar_changeFeed.size();
+	const int from = *sequence;
+
+	*sequence = head;
+	if ( from < cvar_changeFeedBase || from > head || head - from > maxHandles ) {
+		return -1;
+	}
+	std::copy( cvar_changeFeed.begin() + (from - cvar_changeFeedBase), cvar_changeFeed.end(), handles );
+	return head - from;
+}
+
 /*
 ============
 Cvar_VariableValue
@@ -303,7 +351,6 @@ The flags will be or'ed in if the variable exists.
 */
 cvar_t *Cvar_Get( const char *var_name, const char *var_value, uint32_t flags, const char *var_desc ) {
 	cvar_t	*var;
-	int		index;
 
     if ( !var_name || ! var_value ) {
 		Com_Error( ERR_FATAL, "Cvar_Get: NULL parameter" );
@@ -369,6 +416,8 @@ cvar_t *Cvar_Get( const char *var_name, const char *var_value, uint32_t flags, c
 				flags &= ~CVAR_SERVER_CREATED;
 		}
 
+		if ( flags & ~var->flags )
+			cvar_infoGeneration++;
 		var->flags |= flags;
 
 		// only allow one non-empty reset string without a warning
@@ -408,10 +457,9 @@ cvar_t *Cvar_Get( const char *var_name, const char *var_value, uint32_t flags, c
 	// allocate a new cvar
 	//
 	
-	index = cvars.size();
 	var = cvars.emplace( var_name, std::make_unique<cvar_t>() ).first->second.get();
-	var->handle = cvar_handle_inc++;
-	cvar_handle_lookup[var->handle] = var;
+	var->handle = cvar_handles.size();
+	cvar_handles.push_back( var );
 
 	var->name = CopyString (var_name);
 	var->string = CopyString (var_value);
@@ -437,6 +485,7 @@ cvar_t *Cvar_Get( const char *var_name, const char *var_value, uint32_t flags, c
 	var->flags = flags;
 	// note what types of cvars have been modified (userinfo, archive, serverinfo, systeminfo)
 	cvar_modifiedFlags |= var->flags;
+	cvar_infoGeneration++;
 	
 	return var;
 }
@@ -584,8 +633,7 @@ cvar_t *Cvar_Set2( const char *var_name, const char *value, uint32_t defaultFlag
 
 			Com_Printf ("%s will be changed upon restarting.\n", var_name);
 			var->latchedString = CopyString(value);
-			var->modified = qtrue;
-			var->modificationCount++;
+			Cvar_MarkModified( var );
 			return var;
 		}
 
@@ -607,8 +655,7 @@ cvar_t *Cvar_Set2( const char *var_name, const char *value, uint32_t defaultFlag
 	if (!strcmp(value, var->string))
 		return var;		// not changed
 
-	var->modified = qtrue;
-	var->modificationCount++;
+	Cvar_MarkModified( var );
 
 	Cvar_FreeString (var->string);	// free the old value string
 
@@ -978,12 +1025,14 @@ void Cvar_Set_f( void ) {
 			if( !( v->flags & CVAR_USERINFO ) ) {
 				v->flags |= CVAR_USERINFO;
 				cvar_modifiedFlags |= CVAR_USERINFO;
+				cvar_infoGeneration++;
 			}
 			break;
 		case 's':
 			if( !( v->flags & CVAR_SERVERINFO ) ) {
 				v->flags |= CVAR_SERVERINFO;
 				cvar_modifiedFlags |= CVAR_SERVERINFO;
+				cvar_infoGeneration++;
 			}
 			break;
 	}
@@ -1186,10 +1235,15 @@ Unsets a cvar
 cvar_t *Cvar_Unset(cvar_t *cv)
 {
 	cvar_t *next = cv->next;
+	auto iter = cvars.find( istring_view { cv->name } );
 
 	// note what types of cvars have been modified (userinfo, archive, serverinfo, systeminfo)
 	cvar_modifiedFlags |= cv->flags;
 
+	// the handle stays reserved so stale vmCvar_t's are simply ignored
+	cvar_handles[cv->handle] = nullptr;
+	cvar_infoGeneration++;
+
 	if(cv->name)
 		Cvar_FreeString(cv->name);
 	if(cv->description)
@@ -1208,7 +1262,7 @@ cvar_t *Cvar_Unset(cvar_t *cv)
 	if(cv->next)
 		cv->next->prev = cv->prev;
 
-	memset(cv, 0, sizeof(*cv));
+	cvars.erase( iter ); // frees cv
 
 	return next;
 }
@@ -1313,25 +1367,105 @@ void Cvar_Restart_f( void ) {
 
 /*
 =====================
-Cvar_InfoString
+Cvar_CachedInfoString
+
+Keeps one info string per bit up to date.  Value changes are patched in from
+the change feed, so an unchanged string costs nothing to fetch; the string is
+only rebuilt from scratch when the set of cvars carrying the bit may differ.
 =====================
 */
-char	*Cvar_InfoString( int bit ) {
-	static char	info[MAX_INFO_STRING];
+typedef struct cvarInfoCache_s {
+	int		bit;
+	int		generation;
+	int		sequence;
+	char	*info;
+} cvarInfoCache_t;
+
+static char *Cvar_CachedInfoString( int bit, qboolean big ) {
+	static cvarInfoCache_t	caches[2][MAX_CVAR_INFOCACHES];
+	static int				nextEvict[2];
+	static cvarHandle_t		changed[MAX_CVAR_CHANGEFEED];
+	const int		size = big ? BIG_INFO_STRING : MAX_INFO_STRING;
+	cvarInfoCache_t	*cache = NULL;
 	cvar_t	*var;
+	int		i, count;
 
-	info[0] = 0;
+	for ( i = 0; i < MAX_CVAR_INFOCACHES; i++ ) {
+		if ( caches[big][i].bit == bit ) {
+			cache = &caches[big][i];
+			break;
+		}
+		if ( !cache && !caches[big][i].bit ) {
+			cache = &caches[big][i];
+		}
+	}
+	if ( !cache ) {
+		cache = &caches[big][nextEvict[big]];
+		nextEvict[big] = ( nextEvict[big] + 1 ) % MAX_CVAR_INFOCACHES;
+	}
+	if ( cache->bit != bit ) {
+		if ( !cache->info ) {
+			cache->info = (char *)Z_Malloc( size, TAG_SMALL, qtrue );
+		}
+		cache->bit = bit;
+		cache->generation = cvar_infoGeneration - 1;
+	}
 
-	for (var = cvar_vars ; var ; var = var->next)
-	{
-		if (!(var->flags & CVAR_INTERNAL) && var->name &&
-			(var->flags & bit))
+	count = Cvar_ChangeFeed( &cache->sequence, changed, MAX_CVAR_CHANGEFEED );
+
+	if ( cache->generation != cvar_infoGeneration || count < 0 ) {
+		cache->generation = cvar_infoGeneration;
+		cache->info[0] = 0;
+
+		for (var = cvar_vars ; var ; var = var->next)
+		{
+			if (!(var->flags & CVAR_INTERNAL) && var->name &&
+				(var->flags & bit))
+			{
+				if ( big )
+					Info_SetValueForKey_Big (cache->info, var->name, var->string);
+				else
+					Info_SetValueForKey (cache->info, var->name, var->string);
+			}
+		}
+		return cache->info;
+	}
+
+	// drop the old value first, Info_SetValueForKey refuses some values without
+	// touching the key, and the full rebuild above would not have the key at all
+	for ( i = 0; i < count; i++ ) {
+		if ( (unsigned)changed[i] >= cvar_handles.size() ) {
+			continue;
+		}
+		var = cvar_handles[changed[i]];
+		if ( !var || (var->flags & CVAR_INTERNAL) || !var->name ) {
+			continue;
+		}
+
+		if ( big )
+			Info_RemoveKey_Big (cache->info, var->name);
+		else
+			Info_RemoveKey (cache->info, var->name);
+
+		if (var->flags & bit)
 		{
-			Info_SetValueForKey (info, var->name, var->string);
+			if ( big )
+				Info_SetValueForKey_Big (cache->info, var->name, var->string);
+			else
+				Info_SetValueForKey (cache->info, var->name, var->string);
 		}
 	}
 
-	return info;
+	return cache->info;
+}
+
+/*
+=====================
+Cvar_InfoString
+=====================
+*/
+char	*Cvar_InfoString( int bit ) {
+	return Cvar_CachedInfoString( bit, qfalse );
 }
 
 /*
@@ -1342,20 +1476,7 @@ Cvar_InfoString_Big
 =====================
 */
 char	*Cvar_InfoString_Big( int bit ) {
-	static char	info[BIG_INFO_STRING];
-	cvar_t	*var;
-
-	info[0] = 0;
-
-	for (var = cvar_vars ; var ; var = var->next)
-	{
-		if (!(var->flags & CVAR_INTERNAL) && var->name &&
-			(var->flags & bit))
-		{
-			Info_SetValueForKey_Big (info, var->name, var->string);
-		}
-	}
-	return info;
+	return Cvar_CachedInfoString( bit, qtrue );
 }
 
 /*
@@ -1422,19 +1543,18 @@ void	Cvar_Update( vmCvar_t *vmCvar ) {
 	cvar_t	*cv = NULL;
 	assert(vmCvar);
 
-	auto iter = cvar_handle_lookup.find(vmCvar->handle);
-	if ( iter == cvar_handle_lookup.end() ) {
+	if ( (unsigned)vmCvar->handle >= cvar_handles.size() ) {
 		Com_Error( ERR_DROP, "Cvar_Update: handle %u out of range", (unsigned)vmCvar->handle );
 	}
-	
-	cv = iter->second;
+
+	cv = cvar_handles[vmCvar->handle];
+	if ( !cv ) {
+		return;		// variable might have been cleared by a cvar_restart
+	}
 
 	if ( cv->modificationCount == vmCvar->modificationCount ) {
 		return;
 	}
-	if ( !cv->string ) {
-		return;		// variable might have been cleared by a cvar_restart
-	}
 	vmCvar->modificationCount = cv->modificationCount;
 	if ( strlen(cv->string)+1 > MAX_CVAR_VALUE_STRING )
 		Com_Error( ERR_DROP, "Cvar_Update: src %s length %u exceeds MAX_CVAR_VALUE_STRING", cv->string, (unsigned int) strlen(cv->string));
@@ -1470,8 +1590,10 @@ Reads in all archived cvars
 */
 void Cvar_Init (void) {
 	cvars.clear();
-	cvar_handle_lookup.clear();
-	cvar_handle_inc = 0;
+	cvar_handles.clear();
+	cvar_changeFeed.clear();
+	cvar_changeFeedBase = 0;
+	cvar_infoGeneration++;
 
 	cvar_cheats = Cvar_Get( "sv_cheats", "1", CVAR_ROM|CVAR_SYSTEMINFO, "Allow cheats on server if set to 1" );
 
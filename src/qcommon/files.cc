@@ -1042,6 +1042,34 @@ fileHandle_t FS_FOpenFileWrite( const char *filename, qboolean safe ) {
 	return f;
 }
 
+/*
+===========
+FS_FOpenOSFileWrite
+
+Like FS_FOpenFileWrite, but returns the stdio file itself.  The caller owns it
+outright, so it may be written and closed from another thread.
+===========
+*/
+FILE *FS_FOpenOSFileWrite( const char *filename ) {
+	char			*ospath;
+
+	FS_AssertInitialised();
+
+	ospath = FS_BuildOSPath( fs_homepath->string, fs_gamedir, filename );
+
+	if ( fs_debug->integer ) {
+		Com_Printf( "FS_FOpenOSFileWrite: %s\n", ospath );
+	}
+
+	FS_CheckFilenameIsMutable( ospath, __func__ );
+
+	if( FS_CreatePath( ospath ) ) {
+		return NULL;
+	}
+
+	return fopen( ospath, "wb" );
+}
+
 /*
 ===========
 FS_FOpenFileAppend
@@ -6,3 +6,4 @@
 
 objModel_t * Model_LoadObj(char const * name);
 std::shared_ptr<GenericModel const> Model_LoadObj2(char const * name);
+void Model_ClearObjs();
@@ -1,710 +1,405 @@
 #include "models.hh"
 
+#include <charconv>
+#include <memory>
+#include <unordered_map>
 #include <vector>
 
 static constexpr float size_mult = 10.0f;
 
-static std::vector<objModel_t *> loaded_models;
-static std::vector<std::shared_ptr<GenericModel>> loaded_models2;
+char const defaultShader[] = "textures/colors/c_grey";
+
 /*
-int Model_ObjGetVerticies(char const * name, vec3_t * points, int points_num) {
-	objModel_t * surf = Model_LoadObj(name);
-	if (!surf) return -1;
-	int p = 0;
-	for (int v = 0; v < surf->numVerts && p < points_num; v+=3, p++) {
-		points[p][0] = surf->verts[v+0];
-		points[p][1] = surf->verts[v+1];
-		points[p][2] = surf->verts[v+2];
-	}
-	return p;
-}
-*/
+Loaded models are kept until the next Hunk_Clear, which is when everything
+else that belongs to the level is released.  Model_LoadObj hands out raw
+pointers into the entry and is only used by level lifetime code (physics
+props, renderer models), while Model_LoadObj2 hands out a shared pointer
+that keeps the GenericModel alive for as long as the caller holds on to it.
 
-/* FIXME -- should be used when loaded_models is cleared!
-static void Model_FreeObj(objModel_t * mod) {
-	
-	if (mod->numVerts) delete [] mod->verts;
-	if (mod->numUVs) delete [] mod->UVs;
-	if (mod->numNormals) delete [] mod->normals;
-	
-	if (mod->numSurfaces) {
-		for (int i = 0; i < mod->numSurfaces; i++) {
-			if (mod->surfaces[i].numFaces) delete [] mod->surfaces[i].faces;
-		}
-		delete [] mod->surfaces;
-	}
-}
+Parsed models are cached next to the OBJ as "<model>.gmc", keyed on a
+checksum of the OBJ text, so only the first load of a model pays for the
+text parse:
+
+4	OBJ_CACHE_IDENT
+4	OBJ_CACHE_VERSION
+4	checksum of the OBJ text
+4	length of the OBJ text
+4	number of vertices
+4	number of surfaces
+24	mins, maxs
+then the vertex positions, uvs and normals, and per surface:
+MAX_QPATH	shader
+4	number of triangles
+then the triangles
 */
 
-float nullVerts[] = {
-	0.0f, 0.0f, 0.0f,
-	0.0f, 0.0f, 0.0f,
-	0.0f, 0.0f, 0.0f
-};
-float nullUVs[] = {
-	0.0f, 0.0f,
-	0.0f, 0.0f,
-	0.0f, 0.0f,
+#define OBJ_CACHE_IDENT		(('C'<<24)+('M'<<16)+('D'<<8)+'G')
+#define OBJ_CACHE_VERSION	1
+
+struct objCacheHeader {
+	int32_t ident;
+	int32_t version;
+	uint32_t checksum;
+	int32_t source_length;
+	int32_t num_verts;
+	int32_t num_surfaces;
+	qm::vec3_t mins, maxs;
 };
-float nullNormals[] = {
-	0.0f, 0.0f, 0.0f,
-	0.0f, 0.0f, 0.0f,
-	0.0f, 0.0f, 0.0f
+
+struct objEntry {
+	std::shared_ptr<GenericModel> model;
+	
+	// the legacy interface, pointing into model
+	objModel_t legacy;
+	std::unique_ptr<objSurface_t[]> legacy_surfaces;
+	std::unique_ptr<objFace_t[]> legacy_faces;
 };
 
-#define OBJ_MAX_INDICIES 1024
-#define CMD_BUF_LEN 12
-#define FLOAT_BUF_LEN 15
+static istring_map<std::shared_ptr<objEntry>> loaded_models;
 
-char const defaultShader[] = "textures/colors/c_grey";
+//================================================================
+// TEXT PARSER
+//================================================================
 
-objModel_t * Model_LoadObj(char const * name) {
-	
-	for (objModel_t * mod : loaded_models) {
-		if (!strcmp(mod->name, name)) return mod;
-	}
-	
-	fileHandle_t file;
-	long len = FS_FOpenFileRead(name, &file, qfalse);
-	
-	if (len < 0) return nullptr;
-	if (len == 0) {
-		FS_FCloseFile(file);
-		return nullptr;
-	}
-	
-	char * obj_buf = new char[len];
-	FS_Read(obj_buf, len, file);
-	FS_FCloseFile(file);
+static void Obj_SkipSpace(char const *& p, char const * end) {
+	while (p < end && (*p == ' ' || *p == '\t')) p++;
+}
+
+static bool Obj_ParseFloat(char const *& p, char const * end, float & out) {
+	Obj_SkipSpace(p, end);
+	if (p < end && *p == '+') p++;
+	auto [ptr, ec] = std::from_chars(p, end, out);
+	if (ec != std::errc {}) return false;
+	p = ptr;
+	return true;
+}
+
+// resolves a one based, or negative relative, OBJ index to zero based; -1 when absent
+static bool Obj_ParseIndex(char const *& p, char const * end, size_t count, int32_t & out) {
+	int32_t idx;
+	auto [ptr, ec] = std::from_chars(p, end, idx);
+	if (ec != std::errc {} || !idx) return false;
+	p = ptr;
+	out = idx < 0 ? static_cast<int32_t>(count) + idx : idx - 1;
+	return out >= 0 && static_cast<size_t>(out) < count;
+}
+
+static std::shared_ptr<GenericModel> Model_ParseObj(char const * name, char const * text, size_t len) {
 	
-	//objModel_t * mod = new objModel_t {};
+	std::vector<qm::vec3_t> verts;
+	std::vector<qm::vec2_t> uvs;
+	std::vector<qm::vec3_t> normals;
 	
-	struct objWorkElement {
-		int vert = 0;
-		int uv = 0;
-		int normal = 0;
-	};
+	auto mod = std::make_shared<GenericModel>();
+	mod->name = name;
 	
-	struct objWorkFace {
-		objWorkElement elements [3];
-	};
+	// OBJ indexes positions, uvs and normals separately, GenericModel shares one index across all three
+	std::unordered_map<uint64_t, GenericModel::Element> unique_elements;
+	std::vector<GenericModel::Element> polygon;
 	
-	struct objWorkSurface {
-		char shader[MAX_QPATH];
-		int shaderIndex = 0;
-		std::vector<objWorkFace> faces;
+	auto fail = [&](char const * reason) -> std::shared_ptr<GenericModel> {
+		Com_Printf(S_COLOR_YELLOW "Model_LoadObj: %s in %s\n", reason, name);
+		return nullptr;
 	};
 	
-	std::vector<float> verts;
-	std::vector<float> uvs;
-	std::vector<float> normals;
-	std::vector<objWorkSurface> surfs;
-
-	bool all_good = true;
-	bool seekline = false;
-	long obj_buf_i = 0;
-	
-	while (obj_buf_i < len && all_good) {
+	char const * end = text + len;
+	for (char const * line = text; line < end; ) {
 		
-		switch (obj_buf[obj_buf_i]) {
-		case '\r':
-			obj_buf_i++;
-			continue;
-		case '\n':
-			obj_buf_i++;
-			seekline = false;
-			continue;
-		case '\0':
-			all_good = false;
-			continue;
-		case '#':
-			obj_buf_i++;
-			seekline = true;
-			continue;
-		default:
-			if (seekline) {
-				obj_buf_i++;
-				continue;
-			}
-			break;
-		}
+		char const * eol = static_cast<char const *>(memchr(line, '\n', end - line));
+		if (!eol) eol = end;
+		char const * p = line;
+		line = eol + 1;
 		
-		char cmd_buf[CMD_BUF_LEN];
-		int ci;
-		for (ci = 0; ci < CMD_BUF_LEN; ci++) {
-			switch(obj_buf[obj_buf_i+ci]) {
-			case ' ':
-				cmd_buf[ci] = '\0';
-				break;
-			default:
-				cmd_buf[ci] = obj_buf[obj_buf_i+ci];
-				continue;
-			}
-			break;
-		}
+		char const * line_end = eol;
+		while (line_end > p && (line_end[-1] == '\r' || line_end[-1] == ' ' || line_end[-1] == '\t')) line_end--;
 		
-		if (ci == CMD_BUF_LEN) {
-			all_good = false;
-			break;
-		} else {
-			obj_buf_i += ci + 1;
-		}
+		Obj_SkipSpace(p, line_end);
+		char const * cmd = p;
+		while (p < line_end && *p != ' ' && *p != '\t') p++;
+		std::string_view keyword { cmd, static_cast<size_t>(p - cmd) };
 		
-		if (!strcmp(cmd_buf, "o")) {
-			surfs.emplace_back();
-			seekline = true;
-			continue;
-		} else if (!strcmp(cmd_buf, "v")) {
-			char float_buf[FLOAT_BUF_LEN];
-			for (int v = 0; v < 3; v++) {
-				int vi;
-				for(vi = 0; vi < FLOAT_BUF_LEN; vi++) {
-					switch(obj_buf[obj_buf_i + vi]) {
-					case '\r':
-					case '\n':
-					case ' ':
-						float_buf[vi] = '\0';
-						break;
-					default:
-						float_buf[vi] = obj_buf[obj_buf_i+vi];
-						continue;
-					}
-					break;
-				}
-				obj_buf_i += vi + 1;
-				float val = strtod(float_buf, nullptr) * size_mult;
-				verts.push_back(val);
-				memset(float_buf, FLOAT_BUF_LEN, sizeof(char));
-			}
-			obj_buf_i -= 2;
-			seekline = true;
-			continue;
-		} else if (!strcmp(cmd_buf, "vn")) {
-				char float_buf[FLOAT_BUF_LEN];
-				for (int v = 0; v < 3; v++) {
-					int vi;
-					for(vi = 0; vi < FLOAT_BUF_LEN; vi++) {
-						switch(obj_buf[obj_buf_i + vi]) {
-						case '\r':
-						case '\n':
-						case ' ':
-							float_buf[vi] = '\0';
-							break;
-						default:
-							float_buf[vi] = obj_buf[obj_buf_i+vi];
-							continue;
-						}
-						break;
-					}
-					obj_buf_i += vi + 1;
-					float val = strtod(float_buf, nullptr);
-					normals.push_back(val);
-					memset(float_buf, FLOAT_BUF_LEN, sizeof(char));
-				}
-				obj_buf_i -= 2;
-				seekline = true;
-				continue;
-		} else if (!strcmp(cmd_buf, "vt")) {
-			char float_buf[FLOAT_BUF_LEN];
-			for (int v = 0; v < 2; v++) {
-				int vi;
-				for(vi = 0; vi < FLOAT_BUF_LEN; vi++) {
-					switch(obj_buf[obj_buf_i + vi]) {
-					case '\r':
-					case '\n':
-					case ' ':
-						float_buf[vi] = '\0';
-						break;
-					default:
-						float_buf[vi] = obj_buf[obj_buf_i+vi];
-						continue;
+		if (keyword == "v") {
+			qm::vec3_t & v = verts.emplace_back();
+			if (!Obj_ParseFloat(p, line_end, v[0]) || !Obj_ParseFloat(p, line_end, v[1]) || !Obj_ParseFloat(p, line_end, v[2]))
+				return fail("bad vertex");
+			v[0] *= size_mult;
+			v[1] *= size_mult;
+			v[2] *= size_mult;
+		} else if (keyword == "vt") {
+			qm::vec2_t & uv = uvs.emplace_back();
+			if (!Obj_ParseFloat(p, line_end, uv[0]) || !Obj_ParseFloat(p, line_end, uv[1]))
+				return fail("bad texture coordinate");
+			uv[1] = 1 - uv[1];
+		} else if (keyword == "vn") {
+			qm::vec3_t & n = normals.emplace_back();
+			if (!Obj_ParseFloat(p, line_end, n[0]) || !Obj_ParseFloat(p, line_end, n[1]) || !Obj_ParseFloat(p, line_end, n[2]))
+				return fail("bad normal");
+		} else if (keyword == "o") {
+			mod->surfaces.emplace_back().shader = defaultShader;
+		} else if (keyword == "usemtl") {
+			if (mod->surfaces.empty()) mod->surfaces.emplace_back();
+			Obj_SkipSpace(p, line_end);
+			if (line_end - p >= MAX_QPATH) Com_Error(ERR_DROP, "Obj model shader field exceeds MAX_QPATH(%i)", int(MAX_QPATH));
+			mod->surfaces.back().shader.assign(p, line_end - p);
+		} else if (keyword == "f") {
+			if (mod->surfaces.empty()) mod->surfaces.emplace_back().shader = defaultShader;
+			
+			polygon.clear();
+			for (Obj_SkipSpace(p, line_end); p < line_end; Obj_SkipSpace(p, line_end)) {
+				int32_t v, vt = -1, vn = -1;
+				if (!Obj_ParseIndex(p, line_end, verts.size(), v)) return fail("bad face");
+				if (p < line_end && *p == '/') {
+					p++;
+					if (p < line_end && *p != '/' && !Obj_ParseIndex(p, line_end, uvs.size(), vt)) return fail("bad face");
+					if (p < line_end && *p == '/') {
+						p++;
+						if (!Obj_ParseIndex(p, line_end, normals.size(), vn)) return fail("bad face");
 					}
-					break;
 				}
-				obj_buf_i += vi + 1;
-				float val = strtod(float_buf, nullptr);
-				if (v) val = 1 - val;
-				uvs.push_back(val);
-				memset(float_buf, FLOAT_BUF_LEN, sizeof(char));
-			}
-			obj_buf_i -= 2;
-			seekline = true;
-			continue;
-		} else if (!strcmp(cmd_buf, "f")) {
-			objWorkSurface & cursurf = surfs.back();
-			objWorkFace face;
-			for (int fi = 0; fi < 3; fi++) {
-				objWorkElement element;
-				char int_buf[FLOAT_BUF_LEN];
-				for (int v = 0; v < 3; v++) {
-					int vi;
-					for(vi = 0; vi < FLOAT_BUF_LEN; vi++) {
-						switch(obj_buf[obj_buf_i + vi]) {
-						case '\r':
-						case '\n':
-						case ' ':
-							int_buf[vi] = '\0';
-							v += 3;
-							break;
-						case '\\':
-						case '/':
-							int_buf[vi] = '\0';
-							break;
-						default:
-							int_buf[vi] = obj_buf[obj_buf_i+vi];
-							continue;
-						}
-						break;
-					}
-					obj_buf_i += vi + 1;
-					int val = strtol(int_buf, nullptr, 10) - 1;
-					switch(v) {
-					case 0:
-					case 3:
-						element.vert = val;
-					case 1:
-					case 4:
-						element.uv = val;
-					case 2:
-					case 5:
-						element.normal = val;
-					}
-					memset(int_buf, FLOAT_BUF_LEN, sizeof(char));
+				
+				if (v >= (1 << 21) - 1 || vt >= (1 << 21) - 1 || vn >= (1 << 21) - 1) return fail("too many vertices");
+				uint64_t key = static_cast<uint64_t>(v) | static_cast<uint64_t>(vt + 1) << 21 | static_cast<uint64_t>(vn + 1) << 42;
+				
+				auto [iter, inserted] = unique_elements.try_emplace(key, static_cast<GenericModel::Element>(mod->verts.size()));
+				if (inserted) {
+					mod->verts.emplace_back(verts[v]);
+					mod->uvs.emplace_back(vt >= 0 ? uvs[vt] : qm::vec2_t { 0, 0 });
+					mod->normals.emplace_back(vn >= 0 ? normals[vn] : qm::vec3_t { 0, 0, 0 });
 				}
-				face.elements[fi] = element;
+				polygon.emplace_back(iter->second);
 			}
-			cursurf.faces.push_back(face);
-			obj_buf_i -= 2;
-			seekline = true;
-			continue;
-		} else if (!strcmp(cmd_buf, "usemtl")) {
-			objWorkSurface & cursurf = surfs.back();
-			char nam_buf[MAX_QPATH];
-			memset(nam_buf, '\0', MAX_QPATH);
-			int ci = 0;
-			while (true) {
-				if (ci >= MAX_QPATH) Com_Error(ERR_DROP, "Obj model shader field exceeds MAX_QPATH(%i)", int(MAX_QPATH));
-				switch(obj_buf[obj_buf_i]) {
-				case '\r':
-				case '\n':
-				case ' ':
-					nam_buf[ci++] = '\0';
-					obj_buf_i++;
-					break;
-				case '\\':
-					nam_buf[ci++] = '\0';
-					obj_buf_i++;
-					break;
-				default:
-					nam_buf[ci++] = obj_buf[obj_buf_i];
-					obj_buf_i++;
-					continue;
-				}
-				break;
-			}
-
-			strcpy(cursurf.shader, nam_buf);
-
-			obj_buf_i -= 2;
-			seekline = true;
-			continue;
-		} else {
-			seekline = true;
-			continue;
+			if (polygon.size() < 3) return fail("degenerate face");
+			
+			// fan out polygons, flipping the winding into the engine's
+			for (size_t i = 2; i < polygon.size(); i++)
+				mod->surfaces.back().triangles.push_back({ polygon[i], polygon[i - 1], polygon[0] });
 		}
 	}
 	
-	if (all_good) {
-	} else {
-		Com_Printf("Obj Load Failed.\n");
-		return nullptr;
+	if (mod->verts.empty()) return fail("no faces");
+	
+	mod->mins = mod->maxs = mod->verts[0];
+	for (qm::vec3_t const & v : mod->verts) {
+		for (int i = 0; i < 3; i++) {
+			if (v[i] < mod->mins[i]) mod->mins[i] = v[i];
+			if (v[i] > mod->maxs[i]) mod->maxs[i] = v[i];
+		}
 	}
 	
-	objModel_t * mod = new objModel_t;
+	return mod;
+}
+
+//================================================================
+// BINARY CACHE
+//================================================================
+
+static void Model_ObjCacheName(char const * name, char * out, int out_size) {
+	COM_StripExtension(name, out, out_size);
+	Q_strcat(out, out_size, ".gmc");
+}
+
+static std::shared_ptr<GenericModel> Model_ReadObjCache(char const * name, uint32_t checksum, int32_t source_length) {
 	
-	VectorSet(mod->mins, verts[0], verts[1], verts[2]);
-	VectorSet(mod->maxs, verts[0], verts[1], verts[2]);
+	char cache_name[MAX_QPATH];
+	Model_ObjCacheName(name, cache_name, sizeof(cache_name));
 	
-	for (int i = 3; i < verts.size(); i += 3) {
-		if (verts[i] < mod->mins[0]) mod->mins[0] = verts[i];
-		else if (verts[i] > mod->maxs[0]) mod->maxs[0] = verts[i];
-		if (verts[i+1] < mod->mins[1]) mod->mins[1] = verts[i+1];
-		else if (verts[i+1] > mod->maxs[1]) mod->maxs[1] = verts[i+1];
-		if (verts[i+2] < mod->mins[2]) mod->mins[2] = verts[i+2];
-		else if (verts[i+2] > mod->maxs[2]) mod->maxs[2] = verts[i+2];
+	byte * buf;
+	long len = FS_ReadFile(cache_name, reinterpret_cast<void **>(&buf));
+	if (len <= 0) {
+		if (len == 0) FS_FreeFile(buf);
+		return nullptr;
 	}
 	
-	mod->numVerts = verts.size();
-	mod->verts = new float [mod->numVerts];
-	memcpy(mod->verts, verts.data(), mod->numVerts * sizeof(float));
-	
-	mod->numUVs = uvs.size();
-	mod->UVs = new float [mod->numUVs];
-	memcpy(mod->UVs, uvs.data(), mod->numUVs * sizeof(float));
+	byte const * p = buf;
+	byte const * end = buf + len;
+	auto remaining = [&]() -> size_t {
+		return static_cast<size_t>(end - p);
+	};
+	auto read = [&](void * dst, size_t size) -> bool {
+		if (remaining() < size) return false;
+		memcpy(dst, p, size);
+		p += size;
+		return true;
+	};
 	
-	mod->numNormals = normals.size();
-	mod->normals = new float [mod->numNormals];
-	memcpy(mod->normals, normals.data(), mod->numNormals * sizeof(float));
+	auto mod = std::make_shared<GenericModel>();
+	mod->name = name;
 	
-	mod->numVerts /= 3;
-	mod->numUVs /= 2;
-	mod->numNormals /= 3;
+	objCacheHeader header;
+	bool good = read(&header, sizeof(header))
+		&& header.ident == OBJ_CACHE_IDENT && header.version == OBJ_CACHE_VERSION
+		&& header.checksum == checksum && header.source_length == source_length
+		&& header.num_verts > 0 && header.num_surfaces >= 0;
+	
+	// counts come from the file, check them against what is left of it before allocating anything
+	good = good
+		&& remaining() >= static_cast<size_t>(header.num_verts) * (sizeof(qm::vec3_t) + sizeof(qm::vec2_t) + sizeof(qm::vec3_t))
+		&& remaining() / (MAX_QPATH + sizeof(int32_t)) >= static_cast<size_t>(header.num_surfaces);
+	
+	if (good) {
+		mod->mins = header.mins;
+		mod->maxs = header.maxs;
+		mod->verts.resize(header.num_verts);
+		mod->uvs.resize(header.num_verts);
+		mod->normals.resize(header.num_verts);
+		good = read(mod->verts.data(), mod->verts.size() * sizeof(qm::vec3_t))
+			&& read(mod->uvs.data(), mod->uvs.size() * sizeof(qm::vec2_t))
+			&& read(mod->normals.data(), mod->normals.size() * sizeof(qm::vec3_t));
+	}
 	
-	mod->numSurfaces = surfs.size();
-	mod->surfaces = new objSurface_t [mod->numSurfaces];
-	for (int s = 0; s < mod->numSurfaces; s++) {
-		
-		objSurface_t & surfTo = mod->surfaces[s];
-		objWorkSurface & surfFrom = surfs[s];
-		
-		if (strlen(surfFrom.shader)) strcpy(surfTo.shader, surfFrom.shader);
-		else strcpy(surfTo.shader, defaultShader);
-		surfTo.shaderIndex = surfFrom.shaderIndex;
+	for (int32_t s = 0; good && s < header.num_surfaces; s++) {
+		GenericModel::Surface & surf = mod->surfaces.emplace_back();
+		char shader[MAX_QPATH];
+		int32_t num_triangles;
+		good = read(shader, sizeof(shader)) && read(&num_triangles, sizeof(num_triangles))
+			&& num_triangles >= 0 && remaining() >= num_triangles * sizeof(GenericModel::Triangle);
+		if (!good) break;
 		
-		surfTo.numFaces = surfFrom.faces.size();
-		surfTo.faces = new objFace_t [surfTo.numFaces];
-		for (int f = 0; f < surfTo.numFaces; f++) {
-			
-			objFace_t & faceT = surfTo.faces[f];
-			objWorkFace & faceF = surfFrom.faces[f];
-			
-			faceT[0].vertex = &mod->verts[faceF.elements[2].vert * 3];
-			faceT[1].vertex = &mod->verts[faceF.elements[1].vert * 3];
-			faceT[2].vertex = &mod->verts[faceF.elements[0].vert * 3];
-			
-			faceT[0].uv = &mod->UVs[faceF.elements[2].uv * 2];
-			faceT[1].uv = &mod->UVs[faceF.elements[1].uv * 2];
-			faceT[2].uv = &mod->UVs[faceF.elements[0].uv * 2];
-			
-			faceT[0].normal = &mod->normals[faceF.elements[2].normal * 3];
-			faceT[1].normal = &mod->normals[faceF.elements[1].normal * 3];
-			faceT[2].normal = &mod->normals[faceF.elements[0].normal * 3];
-		}
+		shader[MAX_QPATH - 1] = '\0';
+		surf.shader = shader;
+		surf.triangles.resize(num_triangles);
+		read(surf.triangles.data(), num_triangles * sizeof(GenericModel::Triangle));
+		for (GenericModel::Triangle const & tri : surf.triangles)
+			for (GenericModel::Element e : tri)
+				if (e >= static_cast<GenericModel::Element>(header.num_verts)) good = false;
 	}
 	
-	loaded_models.push_back(mod);
+	good = good && p == end;
 	
+	FS_FreeFile(buf);
+	if (!good) {
+		Com_DPrintf("Model_LoadObj: %s is out of date\n", cache_name);
+		return nullptr;
+	}
 	return mod;
 }
 
-std::shared_ptr<GenericModel const> Model_LoadObj2(char const * name) {
-	
-	for (auto & mod : loaded_models2) {
-		if (mod->name == name) return mod;
-	}
-	
-	fileHandle_t file;
-	long len = FS_FOpenFileRead(name, &file, qfalse);
-	
-	if (len < 0) return nullptr;
-	if (len == 0) {
-		FS_FCloseFile(file);
-		return nullptr;
-	}
-	
-	char * obj_buf = new char[len];
-	FS_Read(obj_buf, len, file);
-	FS_FCloseFile(file);
-	
-	//objModel_t * mod = new objModel_t {};
-	
-	struct objWorkElement {
-		int vert = 0;
-		int uv = 0;
-		int normal = 0;
-	};
+static void Model_WriteObjCache(GenericModel const & mod, uint32_t checksum, int32_t source_length) {
 	
-	struct objWorkFace {
-		objWorkElement elements [3];
+	std::vector<byte> buf;
+	auto write = [&](void const * src, size_t size) {
+		byte const * b = static_cast<byte const *>(src);
+		buf.insert(buf.end(), b, b + size);
 	};
 	
-	struct objWorkSurface {
-		char shader[MAX_QPATH];
-		int shaderIndex = 0;
-		std::vector<objWorkFace> faces;
-	};
+	objCacheHeader header;
+	header.ident = OBJ_CACHE_IDENT;
+	header.version = OBJ_CACHE_VERSION;
+	header.checksum = checksum;
+	header.source_length = source_length;
+	header.num_verts = mod.verts.size();
+	header.num_surfaces = mod.surfaces.size();
+	header.mins = mod.mins;
+	header.maxs = mod.maxs;
+	write(&header, sizeof(header));
+	
+	write(mod.verts.data(), mod.verts.size() * sizeof(qm::vec3_t));
+	write(mod.uvs.data(), mod.uvs.size() * sizeof(qm::vec2_t));
+	write(mod.normals.data(), mod.normals.size() * sizeof(qm::vec3_t));
+	
+	for (GenericModel::Surface const & surf : mod.surfaces) {
+		char shader[MAX_QPATH] {};
+		Q_strncpyz(shader, surf.shader.c_str(), sizeof(shader));
+		int32_t num_triangles = surf.triangles.size();
+		write(shader, sizeof(shader));
+		write(&num_triangles, sizeof(num_triangles));
+		write(surf.triangles.data(), surf.triangles.size() * sizeof(GenericModel::Triangle));
+	}
 	
-	std::vector<float> verts;
-	std::vector<float> uvs;
-	std::vector<float> normals;
-	std::vector<objWorkSurface> surfs;
+	char cache_name[MAX_QPATH];
+	Model_ObjCacheName(mod.name.c_str(), cache_name, sizeof(cache_name));
+	FS_WriteFile(cache_name, buf.data(), buf.size());
+}
 
-	bool all_good = true;
-	bool seekline = false;
-	long obj_buf_i = 0;
-	
-	while (obj_buf_i < len && all_good) {
-		
-		switch (obj_buf[obj_buf_i]) {
-		case '\r':
-			obj_buf_i++;
-			continue;
-		case '\n':
-			obj_buf_i++;
-			seekline = false;
-			continue;
-		case '\0':
-			all_good = false;
-			continue;
-		case '#':
-			obj_buf_i++;
-			seekline = true;
-			continue;
-		default:
-			if (seekline) {
-				obj_buf_i++;
-				continue;
-			}
-			break;
-		}
+//================================================================
+// REGISTRY
+//================================================================
+
+static std::shared_ptr<objEntry> Model_MakeObjEntry(std::shared_ptr<GenericModel> model) {
+	
+	auto entry = std::make_shared<objEntry>();
+	objModel_t & mod = entry->legacy;
+	
+	Q_strncpyz(mod.name, model->name.c_str(), sizeof(mod.name));
+	mod.numVerts = mod.numUVs = mod.numNormals = model->verts.size();
+	mod.verts = reinterpret_cast<float *>(model->verts.data());
+	mod.UVs = reinterpret_cast<float *>(model->uvs.data());
+	mod.normals = reinterpret_cast<float *>(model->normals.data());
+	VectorCopy(model->mins, mod.mins);
+	VectorCopy(model->maxs, mod.maxs);
+	
+	size_t num_faces = 0;
+	for (GenericModel::Surface const & surf : model->surfaces)
+		num_faces += surf.triangles.size();
+	
+	mod.numSurfaces = model->surfaces.size();
+	entry->legacy_surfaces = std::make_unique<objSurface_t[]>(mod.numSurfaces);
+	entry->legacy_faces = std::make_unique<objFace_t[]>(num_faces);
+	mod.surfaces = entry->legacy_surfaces.get();
+	
+	objFace_t * face = entry->legacy_faces.get();
+	for (int s = 0; s < mod.numSurfaces; s++) {
 		
-		char cmd_buf[CMD_BUF_LEN];
-		int ci;
-		for (ci = 0; ci < CMD_BUF_LEN; ci++) {
-			switch(obj_buf[obj_buf_i+ci]) {
-			case ' ':
-				cmd_buf[ci] = '\0';
-				break;
-			default:
-				cmd_buf[ci] = obj_buf[obj_buf_i+ci];
-				continue;
-			}
-			break;
-		}
+		GenericModel::Surface const & surfFrom = model->surfaces[s];
+		objSurface_t & surfTo = mod.surfaces[s];
 		
-		if (ci == CMD_BUF_LEN) {
-			all_good = false;
-			break;
-		} else {
-			obj_buf_i += ci + 1;
-		}
+		Q_strncpyz(surfTo.shader, surfFrom.shader.empty() ? defaultShader : surfFrom.shader.c_str(), sizeof(surfTo.shader));
+		surfTo.shaderIndex = 0;
+		surfTo.numFaces = surfFrom.triangles.size();
+		surfTo.faces = face;
 		
-		if (!strcmp(cmd_buf, "o")) {
-			surfs.emplace_back();
-			seekline = true;
-			continue;
-		} else if (!strcmp(cmd_buf, "v")) {
-			char float_buf[FLOAT_BUF_LEN];
-			for (int v = 0; v < 3; v++) {
-				int vi;
-				for(vi = 0; vi < FLOAT_BUF_LEN; vi++) {
-					switch(obj_buf[obj_buf_i + vi]) {
-					case '\r':
-					case '\n':
-					case ' ':
-						float_buf[vi] = '\0';
-						break;
-					default:
-						float_buf[vi] = obj_buf[obj_buf_i+vi];
-						continue;
-					}
-					break;
-				}
-				obj_buf_i += vi + 1;
-				float val = strtod(float_buf, nullptr) * size_mult;
-				verts.push_back(val);
-				memset(float_buf, FLOAT_BUF_LEN, sizeof(char));
+		for (GenericModel::Triangle const & tri : surfFrom.triangles) {
+			for (int i = 0; i < 3; i++) {
+				(*face)[i].vertex = &mod.verts[tri[i] * 3];
+				(*face)[i].uv = &mod.UVs[tri[i] * 2];
+				(*face)[i].normal = &mod.normals[tri[i] * 3];
 			}
-			obj_buf_i -= 2;
-			seekline = true;
-			continue;
-		} else if (!strcmp(cmd_buf, "vn")) {
-				char float_buf[FLOAT_BUF_LEN];
-				for (int v = 0; v < 3; v++) {
-					int vi;
-					for(vi = 0; vi < FLOAT_BUF_LEN; vi++) {
-						switch(obj_buf[obj_buf_i + vi]) {
-						case '\r':
-						case '\n':
-						case ' ':
-							float_buf[vi] = '\0';
-							break;
-						default:
-							float_buf[vi] = obj_buf[obj_buf_i+vi];
-							continue;
-						}
-						break;
-					}
-					obj_buf_i += vi + 1;
-					float val = strtod(float_buf, nullptr);
-					normals.push_back(val);
-					memset(float_buf, FLOAT_BUF_LEN, sizeof(char));
-				}
-				obj_buf_i -= 2;
-				seekline = true;
-				continue;
-		} else if (!strcmp(cmd_buf, "vt")) {
-			char float_buf[FLOAT_BUF_LEN];
-			for (int v = 0; v < 2; v++) {
-				int vi;
-				for(vi = 0; vi < FLOAT_BUF_LEN; vi++) {
-					switch(obj_buf[obj_buf_i + vi]) {
-					case '\r':
-					case '\n':
-					case ' ':
-						float_buf[vi] = '\0';
-						break;
-					default:
-						float_buf[vi] = obj_buf[obj_buf_i+vi];
-						continue;
-					}
-					break;
-				}
-				obj_buf_i += vi + 1;
-				float val = strtod(float_buf, nullptr);
-				if (v) val = 1 - val;
-				uvs.push_back(val);
-				memset(float_buf, FLOAT_BUF_LEN, sizeof(char));
-			}
-			obj_buf_i -= 2;
-			seekline = true;
-			continue;
-		} else if (!strcmp(cmd_buf, "f")) {
-			objWorkSurface & cursurf = surfs.back();
-			objWorkFace face;
-			for (int fi = 0; fi < 3; fi++) {
-				objWorkElement element;
-				char int_buf[FLOAT_BUF_LEN];
-				for (int v = 0; v < 3; v++) {
-					int vi;
-					for(vi = 0; vi < FLOAT_BUF_LEN; vi++) {
-						switch(obj_buf[obj_buf_i + vi]) {
-						case '\r':
-						case '\n':
-						case ' ':
-							int_buf[vi] = '\0';
-							v += 3;
-							break;
-						case '\\':
-						case '/':
-							int_buf[vi] = '\0';
-							break;
-						default:
-							int_buf[vi] = obj_buf[obj_buf_i+vi];
-							continue;
-						}
-						break;
-					}
-					obj_buf_i += vi + 1;
-					int val = strtol(int_buf, nullptr, 10) - 1;
-					switch(v) {
-					case 0:
-					case 3:
-						element.vert = val;
-					case 1:
-					case 4:
-						element.uv = val;
-					case 2:
-					case 5:
-						element.normal = val;
-					}
-					memset(int_buf, FLOAT_BUF_LEN, sizeof(char));
-				}
-				face.elements[fi] = element;
-			}
-			cursurf.faces.push_back(face);
-			obj_buf_i -= 2;
-			seekline = true;
-			continue;
-		} else if (!strcmp(cmd_buf, "usemtl")) {
-			objWorkSurface & cursurf = surfs.back();
-			char nam_buf[MAX_QPATH];
-			memset(nam_buf, '\0', MAX_QPATH);
-			int ci = 0;
-			while (true) {
-				if (ci >= MAX_QPATH) Com_Error(ERR_DROP, "Obj model shader field exceeds MAX_QPATH(%i)", int(MAX_QPATH));
-				switch(obj_buf[obj_buf_i]) {
-				case '\r':
-				case '\n':
-				case ' ':
-					nam_buf[ci++] = '\0';
-					obj_buf_i++;
-					break;
-				case '\\':
-					nam_buf[ci++] = '\0';
-					obj_buf_i++;
-					break;
-				default:
-					nam_buf[ci++] = obj_buf[obj_buf_i];
-					obj_buf_i++;
-					continue;
-				}
-				break;
-			}
-
-			strcpy(cursurf.shader, nam_buf);
-
-			obj_buf_i -= 2;
-			seekline = true;
-			continue;
-		} else {
-			seekline = true;
-			continue;
+			face++;
 		}
 	}
 	
-	if (all_good) {
-	} else {
-		Com_Printf("Obj Load Failed.\n");
-		return nullptr;
-	}
+	entry->model = std::move(model);
+	return entry;
+}
+
+static objEntry * Model_FindObj(char const * name) {
 	
-	std::shared_ptr<GenericModel> mod = std::make_shared<GenericModel>();
+	auto iter = loaded_models.find(name);
+	if (iter != loaded_models.end()) return iter->second.get();
 	
-	mod->name = name;
-	mod->maxs = mod->mins = { verts[0], verts[1], verts[2] };
-	
-	for (uint32_t i = 3; i < verts.size(); i += 3) {
-		if (verts[i] < mod->mins[0]) mod->mins[0] = verts[i];
-		else if (verts[i] > mod->maxs[0]) mod->maxs[0] = verts[i];
-		if (verts[i+1] < mod->mins[1]) mod->mins[1] = verts[i+1];
-		else if (verts[i+1] > mod->maxs[1]) mod->maxs[1] = verts[i+1];
-		if (verts[i+2] < mod->mins[2]) mod->mins[2] = verts[i+2];
-		else if (verts[i+2] > mod->maxs[2]) mod->maxs[2] = verts[i+2];
+	char * text;
+	long len = FS_ReadFile(name, reinterpret_cast<void **>(&text));
+	if (len <= 0) {
+		if (len == 0) FS_FreeFile(text);
+		return nullptr;
 	}
 	
-	mod->verts.resize(verts.size() / 3);
-	mod->uvs.resize(uvs.size() / 2);
-	mod->normals.resize(normals.size() / 3);
-	memcpy(reinterpret_cast<float *>(mod->verts.data()), verts.data(), verts.size() * sizeof(float));
-	memcpy(reinterpret_cast<float *>(mod->uvs.data()), uvs.data(), uvs.size() * sizeof(float));
-	memcpy(reinterpret_cast<float *>(mod->normals.data()), normals.data(), normals.size() * sizeof(float));
-	
-	/*
-	mod->numSurfaces = surfs.size();
-	mod->surfaces = new objSurface_t [mod->numSurfaces];
-	for (int s = 0; s < mod->numSurfaces; s++) {
-		
-		objSurface_t & surfTo = mod->surfaces[s];
-		objWorkSurface & surfFrom = surfs[s];
-		
-		if (strlen(surfFrom.shader)) strcpy(surfTo.shader, surfFrom.shader);
-		else strcpy(surfTo.shader, defaultShader);
-		surfTo.shaderIndex = surfFrom.shaderIndex;
-		
-		surfTo.numFaces = surfFrom.faces.size();
-		surfTo.faces = new objFace_t [surfTo.numFaces];
-		for (int f = 0; f < surfTo.numFaces; f++) {
-			
-			objFace_t & faceT = surfTo.faces[f];
-			objWorkFace & faceF = surfFrom.faces[f];
-			
-			faceT[0].vertex = &mod->verts[faceF.elements[2].vert * 3];
-			faceT[1].vertex = &mod->verts[faceF.elements[1].vert * 3];
-			faceT[2].vertex = &mod->verts[faceF.elements[0].vert * 3];
-			
-			faceT[0].uv = &mod->UVs[faceF.elements[2].uv * 2];
-			faceT[1].uv = &mod->UVs[faceF.elements[1].uv * 2];
-			faceT[2].uv = &mod->UVs[faceF.elements[0].uv * 2];
-			
-			faceT[0].normal = &mod->normals[faceF.elements[2].normal * 3];
-			faceT[1].normal = &mod->normals[faceF.elements[1].normal * 3];
-			faceT[2].normal = &mod->normals[faceF.elements[0].normal * 3];
-		}
+	uint32_t checksum = Com_BlockChecksum(text, len);
+	std::shared_ptr<GenericModel> model = Model_ReadObjCache(name, checksum, len);
+	if (!model) {
+		model = Model_ParseObj(name, text, len);
+		if (model) Model_WriteObjCache(*model, checksum, len);
 	}
+	FS_FreeFile(text);
 	
-	loaded_models.push_back(mod);
-	*/
+	if (!model) {
+		Com_Printf("Obj Load Failed.\n");
+		return nullptr;
+	}
 	
-	return mod;
+	return loaded_models.emplace(name, Model_MakeObjEntry(std::move(model))).first->second.get();
+}
+
+objModel_t * Model_LoadObj(char const * name) {
+	objEntry * entry = Model_FindObj(name);
+	return entry ? &entry->legacy : nullptr;
+}
+
+std::shared_ptr<GenericModel const> Model_LoadObj2(char const * name) {
+	objEntry * entry = Model_FindObj(name);
+	return entry ? entry->model : nullptr;
+}
+
+void Model_ClearObjs() {
+	loaded_models.clear();
 }
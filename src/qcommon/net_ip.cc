@@ -1034,19 +1034,19 @@ void NET_Event(fd_set *fdr)
 
 /*
 ====================
-NET_Sleep
+NET_SleepUsec
 
-sleeps msec or until net socket is ready
+sleeps usec or until net socket is ready
 ====================
 */
-void NET_Sleep( int msec ) {
+void NET_SleepUsec( int usec ) {
 	struct timeval timeout;
 	fd_set	fdset;
 	int retval;
 	SOCKET highestfd = INVALID_SOCKET;
 
-	if (msec < 0)
-		msec = 0;
+	if (usec < 0)
+		usec = 0;
 
 	FD_ZERO(&fdset);
 	if (ip_socket != INVALID_SOCKET) {
@@ -1059,13 +1059,13 @@ void NET_Sleep( int msec ) {
 	{
 		// windows ain't happy when select is called without valid FDs
 
-		SleepEx(msec, 0);
+		SleepEx(usec / 1000, 0);
 		return;
 	}
 #endif
 
-	timeout.tv_sec = msec/1000;
-	timeout.tv_usec = (msec%1000)*1000;
+	timeout.tv_sec = usec/1000000;
+	timeout.tv_usec = usec%1000000;
 
 	retval = select(highestfd + 1, &fdset, NULL, NULL, &timeout);
 
@@ -1075,6 +1075,20 @@ void NET_Sleep( int msec ) {
 		NET_Event(&fdset);
 }
 
+/*
+====================
+NET_Sleep
+
+sleeps msec or until net socket is ready
+====================
+*/
+void NET_Sleep( int msec ) {
+	if (msec < 0)
+		msec = 0;
+
+	NET_SleepUsec( msec * 1000 );
+}
+
 /*
 ====================
 NET_Restart_f
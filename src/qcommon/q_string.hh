@@ -4,8 +4,10 @@
 
 #include <meadow/istring.hh>
 
+#include <cstdint>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 
 using istring = meadow::istring;
 using istring_view = meadow::istring_view;
@@ -51,3 +53,20 @@ void Q_strstrip( char *string, const char *strip, const char *repl );
 #else // not using MSVC
 	#define Q_vsnprintf vsnprintf
 #endif
+
+// case insensitive FNV-1a, transparent so istring keyed containers can be
+// searched with a const char * or istring_view without allocating a key
+struct istring_hash {
+	using is_transparent = void;
+	size_t operator () ( istring_view str ) const noexcept {
+		uint64_t hash = 14695981039346656037ull;
+		for ( char c : str ) {
+			hash ^= static_cast<uint8_t>( c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c );
+			hash *= 1099511628211ull;
+		}
+		return static_cast<size_t>( hash );
+	}
+};
+
+template <typename T>
+using istring_map = std::unordered_map<istring, T, istring_hash, std::equal_to<>>;
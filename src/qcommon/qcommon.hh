@@ -149,6 +149,7 @@ const char	*NET_AdrToString (netadr_t a);
 qboolean	NET_StringToAdr ( const char *s, netadr_t *a);
 qboolean	NET_GetLoopPacket (netsrc_t sock, netadr_t *net_from, msg_t *net_message);
 void		NET_Sleep(int msec);
+void		NET_SleepUsec(int usec);
 
 void		Sys_SendPacket( int length, const void *data, netadr_t to );
 //Does NOT parse port numbers, only base addresses.
@@ -467,6 +468,9 @@ void	Cvar_Register( vmCvar_t *vmCvar, const char *varName, const char *defaultVa
 void	Cvar_Update( vmCvar_t *vmCvar );
 // updates an interpreted modules' version of a cvar
 
+int		Cvar_ChangeFeed( int *sequence, cvarHandle_t *handles, int maxHandles );
+// handles of cvars changed since *sequence, or -1 if the caller must poll everything
+
 cvar_t	*Cvar_Set2(const char *var_name, const char *value, uint32_t defaultFlags, qboolean force);
 //
 
@@ -600,6 +604,8 @@ int		FS_GetModList(  char *listbuf, int bufsize );
 
 fileHandle_t	FS_FOpenFileWrite( const char *qpath, qboolean safe=qtrue );
 // will properly create any needed paths and deal with seperater character issues
+FILE	*FS_FOpenOSFileWrite( const char *qpath );
+// same, but the caller owns the returned FILE and closes it with fclose
 
 int		FS_filelength( fileHandle_t f );
 fileHandle_t FS_SV_FOpenFileWrite( const char *filename );
@@ -791,6 +797,7 @@ extern	cvar_t	*com_G2Report;
 #endif
 
 extern	cvar_t	*com_busyWait;
+extern	cvar_t	*com_framePacing;
 
 // both client and server must agree to pause
 extern	cvar_t	*cl_paused;
@@ -982,6 +989,7 @@ void SV_Shutdown( char *finalmsg );
 void SV_Frame( int msec );
 void SV_PacketEvent( netadr_t from, msg_t *msg );
 int SV_FrameMsec( void );
+int SV_FramePeriodMsec( void );
 qboolean SV_GameCommand( void );
 
 
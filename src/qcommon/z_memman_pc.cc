@@ -23,6 +23,7 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 // Created 3/13/03 by Brian Osman (VV) - Split Zone/Hunk from common
 
 #include "client/client.hh" // hi i'm bad
+#include "qcommon/models.hh"
 
 ////////////////////////////////////////////////
 //
@@ -797,6 +798,7 @@ void Hunk_Clear( void ) {
 
 //	Com_Printf( "Hunk_Clear: reset the hunk ok\n" );
 	VM_Clear();
+	Model_ClearObjs();
 
 //See if any ghoul2 stuff was leaked, at this point it should be all cleaned up.
 #ifdef _FULL_G2_LEAK_CHECKING
@@ -120,7 +120,9 @@ void R_LoadImage( const char *shortname, byte **pic, int *width, int *height ) {
 	}
 
 	// Loop through all the image loaders trying to load this image.
+	// (no va() here, images may be decoded on several threads at once)
 	char extensionlessName[MAX_QPATH];
+	char name[MAX_QPATH];
 	COM_StripExtension(shortname, extensionlessName, sizeof( extensionlessName ));
 	for ( int i = 0; i < numImageLoaders; i++ )
 	{
@@ -131,7 +133,7 @@ void R_LoadImage( const char *shortname, byte **pic, int *width, int *height ) {
 			continue;
 		}
 
-		const char *name = va ("%s.%s", extensionlessName, tryLoader->extension);
+		Com_sprintf (name, sizeof (name), "%s.%s", extensionlessName, tryLoader->extension);
 		tryLoader->loader (name, pic, width, height);
 		if ( *pic )
 		{
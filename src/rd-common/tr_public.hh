@@ -30,7 +30,7 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "../qcommon/qcommon.hh"
 #include "../ghoul2/ghoul2_shared.hh"
 
-#define	REF_API_VERSION 9
+#define	REF_API_VERSION 10
 
 //
 // these are the functions exported by the refresh module
@@ -281,6 +281,8 @@ typedef struct refimport_s {
 	const void *	(*PD_Load)							( const char *name, size_t *size );
 	
 	objModel_t * 	(*Model_LoadObj)					( char const * name);
+	
+	TaskCore *		(*GetTaskCore)						( void );
 } refimport_t;
 
 // this is the only function actually exported at the linker level
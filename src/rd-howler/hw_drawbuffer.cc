@@ -0,0 +1,211 @@
+#include "hw_local.hh"
+using namespace howler;
+
+//================================================================
+// DRAW BUFFER
+//================================================================
+
+q3drawbuffer::q3drawbuffer() {
+	commands.reserve(4096);
+	keys.reserve(8192);
+	m_scratch.reserve(8192);
+	bones.reserve(16384);
+	groups.reserve(1024);
+	m_sprite_quads.reserve(6 * 1024);
+	m_sprite_shaders.reserve(1024);
+	sprite_stream.reserve(6 * 1024);
+	m_histogram.resize(1 << RADIX_BITS);
+}
+
+void q3drawbuffer::clear() {
+	commands.clear();
+	keys.clear();
+	bones.clear();
+	groups.clear();
+	sprite_stream.clear();
+	m_sprite_quads.clear();
+	m_sprite_shaders.clear();
+}
+
+uint64_t q3drawbuffer::make_key(q3shader const * shader, float sort_offset, bool sprite, size_t index) {
+	// sort ascending with 6 fractional bits, so particle offsets of 0.1 still land in their own stage
+	float sort = (shader->sort + sort_offset) * 64.0f;
+	uint64_t sort_bits = static_cast<uint64_t>(std::clamp(sort, 0.0f, 65535.0f));
+	uint64_t depth_bits = shader->depthwrite ? 0 : 1; // depth writers first
+	uint64_t shader_bits = 0xFFFF - (static_cast<uint64_t>(shader->index) & 0xFFFF); // higher index first
+	
+	return (sort_bits << 48) | (depth_bits << 47) | (shader_bits << 31) | (uint64_t {sprite} << 30) | (index & KEY_INDEX_MASK);
+}
+
+q3drawbuffer::command & q3drawbuffer::push(q3shader const * shader, q3mesh * mesh, qm::mat4_t const & mvp) {
+	keys.emplace_back(make_key(shader, 0, false, commands.size()));
+	command & cmd = commands.emplace_back();
+	cmd.shader = shader;
+	cmd.mesh = mesh;
+	cmd.mvp = mvp;
+	return cmd;
+}
+
+void q3drawbuffer::push_sprite(q3shader const * shader, q3sprite_vertex const & v0, q3sprite_vertex const & v1, q3sprite_vertex const & v2, q3sprite_vertex const & v3) {
+	keys.emplace_back(make_key(shader, 0.1f, true, m_sprite_shaders.size()));
+	m_sprite_shaders.emplace_back(shader);
+	m_sprite_quads.emplace_back(v0);
+	m_sprite_quads.emplace_back(v1);
+	m_sprite_quads.emplace_back(v2);
+	m_sprite_quads.emplace_back(v2);
+	m_sprite_quads.emplace_back(v1);
+	m_sprite_quads.emplace_back(v3);
+}
+
+void q3drawbuffer::sort() {
+	
+	size_t const num = keys.size();
+	m_scratch.resize(num);
+	
+	// LSD radix over the group bits only -- each pass is stable and the keys are
+	// already in submission order, so commands keep that order within a group
+	for (uint32_t shift = KEY_GROUP_SHIFT; shift < 64; shift += RADIX_BITS) {
+		uint64_t const mask = (1u << RADIX_BITS) - 1;
+		
+		std::fill(m_histogram.begin(), m_histogram.end(), 0);
+		for (uint64_t key : keys)
+			m_histogram[(key >> shift) & mask]++;
+		
+		if (!num || m_histogram[(keys[0] >> shift) & mask] == num) continue; // every key shares this digit
+		
+		uint32_t offset = 0;
+		for (uint32_t & count : m_histogram) {
+			uint32_t c = count;
+			count = offset;
+			offset += c;
+		}
+		
+		for (uint64_t key : keys)
+			m_scratch[m_histogram[(key >> shift) & mask]++] = key;
+		keys.swap(m_scratch);
+	}
+	
+	// split into groups, merging the vertices of each sprite group into one stream range
+	for (size_t i = 0; i < num; ) {
+		uint64_t const group_bits = keys[i] >> KEY_GROUP_SHIFT;
+		size_t end = i + 1;
+		while (end < num && (keys[end] >> KEY_GROUP_SHIFT) == group_bits) end++;
+		
+		group & grp = groups.emplace_back();
+		grp.first = i;
+		grp.count = end - i;
+		grp.sprites = group_bits & 1;
+		grp.sprite_first = sprite_stream.size();
+		grp.sprite_count = 0;
+		
+		if (grp.sprites) {
+			grp.shader = m_sprite_shaders[keys[i] & KEY_INDEX_MASK];
+			for (size_t k = i; k < end; k++) {
+				q3sprite_vertex const * quad = &m_sprite_quads[(keys[k] & KEY_INDEX_MASK) * 6];
+				sprite_stream.insert(sprite_stream.end(), quad, quad + 6);
+			}
+			grp.sprite_count = sprite_stream.size() - grp.sprite_first;
+		} else {
+			grp.shader = commands[keys[i] & KEY_INDEX_MASK].shader;
+		}
+		
+		i = end;
+	}
+}
+
+//================================================================
+// SPRITE STREAM
+//================================================================
+
+static void wait_fence(GLsync & fence) {
+	while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED);
+	glDeleteSync(fence);
+	fence = nullptr;
+}
+
+q3spritestream::q3spritestream() : q3mesh_basic(mode::triangles) {
+	
+	static constexpr uint_fast16_t offsetof_verts = 0;
+	static constexpr uint_fast16_t sizeof_verts = sizeof(q3sprite_vertex::vert);
+	static constexpr uint_fast16_t offsetof_uv = offsetof_verts + sizeof_verts;
+	static constexpr uint_fast16_t sizeof_uv = sizeof(q3sprite_vertex::uv);
+	static constexpr uint_fast16_t offsetof_norm = offsetof_uv + sizeof_uv;
+	static constexpr uint_fast16_t sizeof_norm = sizeof(q3sprite_vertex::normal);
+	static constexpr uint_fast16_t offsetof_color = offsetof_norm + sizeof_norm;
+	static constexpr uint_fast16_t sizeof_color = sizeof(q3sprite_vertex::color);
+	static constexpr uint_fast16_t sizeof_all = offsetof_color + sizeof_color;
+	static_assert(sizeof_all == sizeof(q3sprite_vertex));
+	
+	glEnableVertexArrayAttrib(m_handle, LAYOUT_VERTEX);
+	glEnableVertexArrayAttrib(m_handle, LAYOUT_UV);
+	glEnableVertexArrayAttrib(m_handle, LAYOUT_NORMAL);
+	glEnableVertexArrayAttrib(m_handle, LAYOUT_COLOR0);
+	
+	glVertexArrayAttribBinding(m_handle, LAYOUT_VERTEX, 0);
+	glVertexArrayAttribBinding(m_handle, LAYOUT_UV, 0);
+	glVertexArrayAttribBinding(m_handle, LAYOUT_NORMAL, 0);
+	glVertexArrayAttribBinding(m_handle, LAYOUT_COLOR0, 0);
+	
+	glVertexArrayAttribFormat(m_handle, LAYOUT_VERTEX, sizeof_verts / 4, GL_FLOAT, GL_FALSE, offsetof_verts);
+	glVertexArrayAttribFormat(m_handle, LAYOUT_UV, sizeof_uv / 4, GL_FLOAT, GL_FALSE, offsetof_uv);
+	glVertexArrayAttribFormat(m_handle, LAYOUT_NORMAL, sizeof_norm / 4, GL_FLOAT, GL_FALSE, offsetof_norm);
+	glVertexArrayAttribFormat(m_handle, LAYOUT_COLOR0, sizeof_color / 4, GL_FLOAT, GL_FALSE, offsetof_color);
+	
+	allocate(6 * 4096);
+}
+
+q3spritestream::~q3spritestream() {
+	for (GLsync & fence : m_fences)
+		if (fence) glDeleteSync(fence);
+	if (m_vbo) glDeleteBuffers(1, &m_vbo);
+}
+
+void q3spritestream::allocate(size_t segment_verts) {
+	
+	// the old buffer may still be read by frames in flight
+	for (GLsync & fence : m_fences)
+		if (fence) wait_fence(fence);
+	if (m_vbo) glDeleteBuffers(1, &m_vbo);
+	
+	GLbitfield const flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	GLsizeiptr const size = SEGMENTS * segment_verts * sizeof(q3sprite_vertex);
+	
+	glCreateBuffers(1, &m_vbo);
+	glNamedBufferStorage(m_vbo, size, nullptr, flags);
+	m_mapped = reinterpret_cast<q3sprite_vertex *>(glMapNamedBufferRange(m_vbo, 0, size, flags));
+	glVertexArrayVertexBuffer(m_handle, 0, m_vbo, 0, sizeof(q3sprite_vertex));
+	
+	m_segment_verts = segment_verts;
+	m_used = 0;
+	m_generation++;
+}
+
+GLint q3spritestream::upload(q3sprite_vertex const * data, size_t num) {
+	if (m_used + num > m_segment_verts) {
+		size_t segment_verts = m_segment_verts;
+		while (segment_verts < m_used + num) segment_verts *= 2;
+		allocate(segment_verts);
+	}
+	
+	size_t first = m_segment * m_segment_verts + m_used;
+	std::copy(data, data + num, m_mapped + first);
+	m_used += num;
+	return first;
+}
+
+void q3spritestream::end_frame() {
+	m_fences[m_segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	m_segment = (m_segment + 1) % SEGMENTS;
+	m_used = 0;
+	
+	if (m_fences[m_segment]) wait_fence(m_fences[m_segment]);
+}
+
+void q3spritestream::draw() {
+	bind();
+	glDrawArrays(GL_TRIANGLES, m_first, m_size);
+	
+	#ifdef _DEBUG
+	m_debug_draw_count++;
+	#endif
+}
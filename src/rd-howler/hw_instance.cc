@@ -35,6 +35,7 @@ void instance::initialize_renderer() {
 	fullquad = q3mesh_basic::generate_fullquad();
 	unitquad = q3mesh_basic::generate_unitquad();
 	skybox = q3mesh_basic::generate_skybox_mesh();
+	m_sprite_stream = std::make_unique<q3spritestream>();
 	
 	textures.generate_named_defaults();
 	
@@ -444,7 +444,8 @@ namespace howler {
 			qm::mat3_t uvm = qm::mat3_t::identity();
 			q3mesh::uniform_info_t const * mesh_uniforms = nullptr;
 			qm::vec4_t shader_color {1, 1, 1, 1};
-			std::vector<qm::mat4_t> const * bone_weights = nullptr;
+			qm::mat4_t const * bone_weights = nullptr;
+			size_t bone_count = 0;
 			qm::vec3_t view_origin;
 			gridlighting_t const * gridlight;
 		};
@@ -907,6 +908,27 @@ namespace howler {
 		using vis_cache_t = std::tuple<int32_t, q3world_draw, std::array<byte, 32>>;
 		std::vector<vis_cache_t> m_vis_cache;
 		
+		// precomputed at load so a vis change is a bitset fill and a few copies
+		static constexpr uint32_t VIS_NO_BATCH = UINT32_MAX;
+		struct vis_batch_t {
+			q3shader_ptr shader;
+			q3mesh_ptr world_mesh;
+			std::vector<GLuint> indicies; // every surface of the batch back to back
+		};
+		struct vis_surface_t {
+			q3worldsurface const * surf;
+			uint32_t batch; // VIS_NO_BATCH for flares
+			uint32_t first, count; // range in the batch's indicies
+		};
+		struct vis_cluster_t {
+			int32_t area;
+			std::vector<uint32_t> surfaces; // sorted indices into m_vis_surfaces
+		};
+		std::vector<vis_batch_t> m_vis_batches;
+		std::vector<vis_surface_t> m_vis_surfaces; // ordered by batch, flares last
+		std::vector<std::vector<vis_cluster_t>> m_vis_clusters; // per cluster, split by area
+		void build_vis_lists();
+		
 		int32_t m_lockpvs_cluster = -1;
 		q3worldnode const * find_leaf(qm::vec3_t const & coords);
 		
@@ -936,6 +958,97 @@ namespace howler {
 		std::unordered_map<q3shader_ptr, world_mesh_pair> m_world_meshes;
 		void build_world_meshes();
 	};
+
+//================================================================
+// DRAW BUFFER
+//================================================================
+	
+	struct q3sprite_vertex {
+		qm::vec3_t vert;
+		qm::vec2_t uv;
+		qm::vec3_t normal;
+		qm::vec4_t color;
+	};
+	
+	// frame-linear command buffer, cleared per scene but never shrunk
+	// recording touches no GL state, so a frame can be rebuilt headless
+	struct q3drawbuffer {
+	
+		struct command {
+			q3shader const * shader; // owned by the registries / world for the frame
+			q3mesh * mesh;
+			qm::mat4_t mvp;
+			qm::mat3_t itm = qm::mat3_t::identity();
+			qm::mat4_t m = qm::mat4_t::identity();
+			qm::vec4_t shader_color = {1, 1, 1, 1};
+			uint32_t bones_first = 0, bones_count = 0;
+			gridlighting_t gridlight {};
+		};
+	
+		// a run of sorted keys sharing shader and sort stage
+		struct group {
+			q3shader const * shader;
+			uint32_t first, count; // into keys
+			bool sprites;
+			uint32_t sprite_first, sprite_count; // into sprite_stream
+		};
+	
+		q3drawbuffer();
+	
+		void clear();
+		command & push(q3shader const * shader, q3mesh * mesh, qm::mat4_t const & mvp);
+		void push_sprite(q3shader const * shader, q3sprite_vertex const & v0, q3sprite_vertex const & v1, q3sprite_vertex const & v2, q3sprite_vertex const & v3);
+		void sort(); // radix sorts the keys, then builds groups and the merged sprite stream
+	
+		inline command const & at(uint64_t key) const { return commands[key & KEY_INDEX_MASK]; }
+	
+		qm::mat4_t vp, sky_vp;
+		qm::vec3_t view_origin;
+	
+		std::vector<command> commands;
+		std::vector<uint64_t> keys;
+		std::vector<qm::mat4_t> bones;
+		std::vector<group> groups;
+		std::vector<q3sprite_vertex> sprite_stream;
+	
+	private:
+		// 16 sort stage | 1 !depthwrite | 16 ~shader index | 1 sprite | 30 index
+		static constexpr uint64_t KEY_INDEX_MASK = (1u << 30) - 1;
+		static constexpr uint32_t KEY_GROUP_SHIFT = 30;
+		static constexpr uint32_t RADIX_BITS = 12;
+		static uint64_t make_key(q3shader const * shader, float sort_offset, bool sprite, size_t index);
+	
+		std::vector<uint64_t> m_scratch;
+		std::vector<uint32_t> m_histogram;
+		std::vector<q3shader const *> m_sprite_shaders;
+		std::vector<q3sprite_vertex> m_sprite_quads; // 6 per quad, submission order
+	};
+	
+	// persistently mapped ring of sprite vertices, one segment per frame in flight
+	struct q3spritestream : public q3mesh_basic {
+		q3spritestream();
+		~q3spritestream();
+	
+		GLint upload(q3sprite_vertex const * data, size_t num); // returns the first vertex
+		inline void range(GLint first, GLsizei count) { m_first = first; m_size = count; }
+		inline uint32_t generation() const { return m_generation; }
+		void end_frame();
+	
+		virtual void draw() override;
+	private:
+		static constexpr size_t SEGMENTS = 3;
+	
+		void allocate(size_t segment_verts);
+	
+		GLuint m_vbo = 0;
+		q3sprite_vertex * m_mapped = nullptr;
+		size_t m_segment_verts = 0;
+		size_t m_segment = 0;
+		size_t m_used = 0;
+		GLint m_first = 0;
+		GLsync m_fences[SEGMENTS] {};
+		uint32_t m_generation = 0; // bumped when the buffer is reallocated
+	};
 	
 //================================================================
 // INSTANCE
@@ -976,13 +1089,21 @@ namespace howler {
 			q3shader_ptr reg(istring const &, bool mipmaps = true, default_shader_mode dmode = default_shader_mode::basic);
 			q3shader_ptr get(qhandle_t);
 			void process_waiting();
+			void prefetch(std::vector<istring> const & names); // decode the images these shaders will use ahead of reg
 		private:
-			std::unordered_map<istring, std::string> source_lookup;
+			std::vector<char> source_data;
+			std::unordered_map<istring, size_t> source_lookup; // offset into source_data
 			std::unordered_map<istring, q3shader_ptr> lookup;
 			std::vector<q3shader_ptr> shaders;
 			std::vector<q3shader_ptr> waiting_shaders;
 			
 			void load_shader(q3shader_ptr shad);
+			void collect_images(istring const & name, std::vector<istring> & images);
+			
+			void scan_sources(char * * files, int num_files);
+			bool source_cache_key(char * * files, int num_files, int32_t & key);
+			bool load_source_cache(int32_t key);
+			void save_source_cache(int32_t key);
 		} shaders;
 		
 		// SKINS
@@ -1011,8 +1132,27 @@ namespace howler {
 			
 			q3texture_ptr reg(istring const & name, bool mips);
 			q3texture_cptr whiteimage;
+			
+			// decodes on the task core, reg then only has to upload
+			void prefetch(std::vector<istring> const & names);
+			void discard_prefetched();
+			
+			// shaders whose images are prefetched together, bounds the decoded images held at once
+			static constexpr size_t prefetch_batch = 32;
+			
+			void decode_benchmark(char const * dir);
 		private:
+			struct decoded_image {
+				byte * data = nullptr;
+				int32_t width = 0, height = 0;
+				bool transparent = false;
+			};
+			
+			static decoded_image decode(char const * name);
+			static void decode_parallel(std::vector<istring> const & names, std::vector<decoded_image> & images);
+			
 			std::unordered_map<istring, q3texture_ptr> lookup;
+			std::unordered_map<istring, decoded_image> prefetched;
 		} textures;
 		
 		float m_cull = 6000;
@@ -1026,6 +1166,7 @@ namespace howler {
 		// CMD funcs
 		void save_lightmap_atlas();
 		void screenshot(char const * name);
+		void draw_benchmark(int32_t iterations);
 		
 		inline q3frame & frame() { return *m_frame; }
 		inline qboolean world_get_entity_token(char * buffer, int size) { return m_world->get_entity_token(buffer, size); }
@@ -1048,6 +1189,25 @@ namespace howler {
 		
 		q3mesh_ptr fullquad, unitquad, skybox;
 		q3frame_ptr m_frame;
+		
+		q3drawbuffer m_drawbuffer;
+		std::unique_ptr<q3spritestream> m_sprite_stream;
+		int32_t m_draw_benchmark = 0; // iterations to run on the next frame
+		
+		// copied out of the draw buffer, drawn once every scene is done
+		struct debug_draw {
+			q3mesh * mesh;
+			qm::mat4_t mvp;
+			uint32_t bones_first = 0, bones_count = 0;
+			GLint first = 0; // sprite stream range
+			GLsizei count = 0;
+			uint32_t generation = 0;
+		};
+		std::vector<debug_draw> m_debug_draws;
+		std::vector<qm::mat4_t> m_debug_bones;
+		
+		void build_scene(q3scene const & scene, float time);
+		void submit_scene(float time, bool draw_sky, bool debug);
 		std::unique_ptr<q3world> m_world = nullptr;
 	};
 }
@@ -14,7 +14,129 @@ instance::shader_registry::shader_registry() {
 	
 	int num_shader_files;
 	char * * shfiles = ri.FS_ListFiles("shaders", ".shader", &num_shader_files);
-	for (int i = 0; i < num_shader_files; i++) {
+	
+	int32_t key;
+	bool cacheable = source_cache_key(shfiles, num_shader_files, key);
+	if (!cacheable || !load_source_cache(key)) {
+		scan_sources(shfiles, num_shader_files);
+		if (cacheable) save_source_cache(key);
+	}
+	
+	ri.FS_FreeFileList(shfiles);
+}
+
+//================================================================
+// SOURCE CACHE
+//================================================================
+
+// Every shader body is kept null terminated in source_data. Scanning all the
+// script files for them is a large part of startup, so the result is saved
+// and reused while the same pk3s provide the same scripts:
+//
+// int32	SHADER_CACHE_IDENT
+// int32	SHADER_CACHE_VERSION
+// int32	key, hash of the script names and their pk3 checksums
+// int32	length of source_data
+// int32	number of shaders
+// source_data
+// then per shader: int32 offset, int32 name length, name
+
+static constexpr char const * SHADER_CACHE_FILE = "shadercache.dat";
+static constexpr int32_t SHADER_CACHE_IDENT = ('C'<<24)+('D'<<16)+('H'<<8)+'S';
+static constexpr int32_t SHADER_CACHE_VERSION = 1;
+
+// loose scripts are being edited, only cache when everything comes from pk3s
+bool instance::shader_registry::source_cache_key(char * * files, int num_files, int32_t & key) {
+	uint32_t hash = 2166136261u;
+	auto hash_bytes = [&](void const * data, size_t len) {
+		for (size_t i = 0; i < len; i++)
+			hash = (hash ^ static_cast<uint8_t const *>(data)[i]) * 16777619u;
+	};
+	
+	hash_bytes(&num_files, sizeof(num_files));
+	for (int i = 0; i < num_files; i++) {
+		int checksum;
+		if (ri.FS_FileIsInPAK(va("shaders/%s", files[i]), &checksum) != 1) return false;
+		hash_bytes(files[i], strlen(files[i]));
+		hash_bytes(&checksum, sizeof(checksum));
+	}
+	
+	key = static_cast<int32_t>(hash);
+	return true;
+}
+
+bool instance::shader_registry::load_source_cache(int32_t key) {
+	// only trust the copy save_source_cache wrote to the home path, FS_ReadFile would prefer one shipped in a pk3
+	if (!ri.FS_FileExists(SHADER_CACHE_FILE) || ri.FS_FileIsInPAK(SHADER_CACHE_FILE, nullptr) == 1) return false;
+	
+	void * buffer;
+	long len = ri.FS_ReadFile(SHADER_CACHE_FILE, &buffer);
+	if (!buffer) return false;
+	
+	byte const * data = static_cast<byte const *>(buffer);
+	byte const * end = data + len;
+	auto read_int = [&](int32_t & v) -> bool {
+		if (end - data < 4) return false;
+		memcpy(&v, data, 4);
+		v = LittleLong(v);
+		data += 4;
+		return true;
+	};
+	
+	bool valid = false;
+	int32_t ident, version, file_key, data_len, count;
+	if (!read_int(ident) || ident != SHADER_CACHE_IDENT) goto done;
+	if (!read_int(version) || version != SHADER_CACHE_VERSION) goto done;
+	if (!read_int(file_key) || file_key != key) goto done;
+	if (!read_int(data_len) || data_len <= 0 || end - data < data_len || data[data_len - 1]) goto done;
+	
+	source_data.assign(data, data + data_len);
+	data += data_len;
+	
+	// every entry is at least an offset, a length and one character
+	if (!read_int(count) || count < 0 || count > (end - data) / 9) goto done;
+	for (int32_t i = 0; i < count; i++) {
+		int32_t offset, name_len;
+		if (!read_int(offset) || offset < 0 || offset >= data_len) goto done;
+		if (!read_int(name_len) || name_len <= 0 || end - data < name_len) goto done;
+		source_lookup[istring { reinterpret_cast<char const *>(data), static_cast<size_t>(name_len) }] = offset;
+		data += name_len;
+	}
+	valid = true;
+	
+	done:
+	ri.FS_FreeFile(buffer);
+	if (!valid) {
+		source_data.clear();
+		source_lookup.clear();
+	}
+	return valid;
+}
+
+void instance::shader_registry::save_source_cache(int32_t key) {
+	std::vector<byte> out;
+	auto write_int = [&](int32_t v) {
+		v = LittleLong(v);
+		out.insert(out.end(), reinterpret_cast<byte const *>(&v), reinterpret_cast<byte const *>(&v) + 4);
+	};
+	
+	write_int(SHADER_CACHE_IDENT);
+	write_int(SHADER_CACHE_VERSION);
+	write_int(key);
+	write_int(static_cast<int32_t>(source_data.size()));
+	out.insert(out.end(), source_data.begin(), source_data.end());
+	write_int(static_cast<int32_t>(source_lookup.size()));
+	for (auto const & [name, offset] : source_lookup) {
+		write_int(static_cast<int32_t>(offset));
+		write_int(static_cast<int32_t>(name.size()));
+		out.insert(out.end(), name.begin(), name.end());
+	}
+	
+	ri.FS_WriteFile(SHADER_CACHE_FILE, out.data(), out.size());
+}
+
+void instance::shader_registry::scan_sources(char * * files, int num_files) {
+	for (int i = 0; i < num_files; i++) {
 		
 		fileHandle_t f;
 		char const * token, * p, * pOld;
@@ -22,12 +144,12 @@ instance::shader_registry::shader_registry() {
 		std::string shdata;
 		int line;
 		
-		int len = ri.FS_FOpenFileRead(va("shaders/%s", shfiles[i]), &f, qfalse);
+		int len = ri.FS_FOpenFileRead(va("shaders/%s", files[i]), &f, qfalse);
 		std::string ff;
 		ff.resize(len);
 		ri.FS_Read(&ff[0], len, f);
 		
-		COM_BeginParseSession(shfiles[i]);
+		COM_BeginParseSession(files[i]);
 		p = ff.c_str();
 		while (true) {
 			token = COM_ParseExt(&p, qtrue);
@@ -62,11 +184,12 @@ instance::shader_registry::shader_registry() {
 			
 			char sname [MAX_QPATH];
 			COM_StripExtension(name.c_str(), sname, MAX_QPATH);
-			source_lookup[sname] = {pOld, p};
+			source_lookup[sname] = source_data.size();
+			source_data.insert(source_data.end(), pOld, p);
+			source_data.push_back('\0');
 		}
 		ri.FS_FCloseFile(f);
 	}
-	ri.FS_FreeFileList(shfiles);
 }
 
 q3shader_ptr instance::shader_registry::reg(istring const & name_in, bool mipmaps, default_shader_mode dmode) {
@@ -101,16 +224,68 @@ q3shader_ptr instance::shader_registry::get(qhandle_t h) {
 }
 
 void instance::shader_registry::process_waiting() {
-	for (q3shader_ptr & shad : waiting_shaders)
-		load_shader(shad);
+	size_t const batch = texture_registry::prefetch_batch;
+	for (size_t b = 0; b < waiting_shaders.size(); b += batch) {
+		size_t const e = std::min(b + batch, waiting_shaders.size());
+		
+		std::vector<istring> images;
+		for (size_t i = b; i < e; i++)
+			collect_images(waiting_shaders[i]->name, images);
+		hw_inst->textures.prefetch(images);
+		
+		for (size_t i = b; i < e; i++)
+			load_shader(waiting_shaders[i]);
+		hw_inst->textures.discard_prefetched();
+	}
 	waiting_shaders.clear();
 }
 
+void instance::shader_registry::prefetch(std::vector<istring> const & names) {
+	std::vector<istring> images;
+	for (istring const & name_in : names) {
+		char name_stripped [MAX_QPATH];
+		COM_StripExtension(name_in.c_str(), name_stripped, MAX_QPATH);
+		istring name = name_stripped;
+		if (lookup.contains(name)) continue;
+		collect_images(name, images);
+	}
+	hw_inst->textures.prefetch(images);
+}
+
+// same names load_shader and parse_stage will hand to textures.reg
+void instance::shader_registry::collect_images(istring const & name, std::vector<istring> & images) {
+	auto src = source_lookup.find(name);
+	if (src == source_lookup.end()) {
+		images.push_back(name);
+		return;
+	}
+	
+	char const * token, * p = source_data.data() + src->second;
+	COM_BeginParseSession("shader");
+	
+	while (true) {
+		token = COM_ParseExt(&p, qtrue);
+		if (!token[0]) break;
+		
+		if (!Q_stricmp("map", token) || !Q_stricmp("clampmap", token)) {
+			token = COM_ParseExt(&p, qfalse);
+			if (token[0] && token[0] != '$') images.emplace_back(token);
+		} else if (!Q_stricmp("animmap", token) || !Q_stricmp("clampanimmap", token) || !Q_stricmp("oneshotanimmap", token)) {
+			COM_ParseExt(&p, qfalse); // speed
+			while (true) {
+				token = COM_ParseExt(&p, qfalse);
+				if (!token[0]) break;
+				images.emplace_back(token);
+			}
+		}
+	}
+}
+
 void instance::shader_registry::load_shader(q3shader_ptr shad) {
 	auto src = source_lookup.find(shad->name);
 	if (src != source_lookup.end()) {
 		
-		if (shad->parse_shader(src->second.c_str(), shad->mips))
+		if (shad->parse_shader(source_data.data() + src->second, shad->mips))
 			return;
 		
 		Com_Printf(S_COLOR_RED "ERROR: Could not parse shader '%s'!\n", shad->name.c_str());
@@ -1073,7 +1248,7 @@ void q3stage::setup_draw(setup_draw_parameters_t const & parm) const {
 	//}
 	
 	if (parm.bone_weights)
-		hw_inst->q3mainprog->bone_matricies(parm.bone_weights->data(), parm.bone_weights->size());
+		hw_inst->q3mainprog->bone_matricies(parm.bone_weights, parm.bone_count);
 	else
 		hw_inst->q3mainprog->bone_matricies(nullptr, 0);
 	
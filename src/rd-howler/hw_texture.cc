@@ -1,6 +1,10 @@
 #include "hw_local.hh"
 using namespace howler;
 
+#include <atomic>
+#include <mutex>
+#include <unordered_set>
+
 q3texture::q3texture(GLsizei width, GLsizei height, bool mipmaps, GLenum type) : m_width(width), m_height(height), m_mips(mipmaps) {
 	glCreateTextures(GL_TEXTURE_2D, 1, &m_handle);
 	glTextureStorage2D(m_handle, m_mips ? std::floor(log2(m_width > m_height ? m_height : m_width)) : 1, type, m_width, m_height);
@@ -70,6 +74,113 @@ void q3sampler::wrap(GLenum wrap) {
 
 // REGISTRY
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define HW_TEXTURE_SSE2
+	#include <emmintrin.h>
+#endif
+
+// row major, four pixels at a time, stops at the first pixel that isn't opaque
+static bool image_has_transparency(byte const * data, size_t pixels) {
+	size_t i = 0;
+#ifdef HW_TEXTURE_SSE2
+	__m128i const alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+	for (; i + 4 <= pixels; i += 4) {
+		__m128i px = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<__m128i const *>(data + i * 4)), alpha);
+		if (_mm_movemask_epi8(_mm_cmpeq_epi32(px, alpha)) != 0xFFFF) return true;
+	}
+#endif
+	for (; i < pixels; i++)
+		if (data[i * 4 + 3] != 0xFF) return true;
+	return false;
+}
+
+// The image loaders call back into the engine for file, zone and console
+// access, none of which is thread safe. While a parallel decode runs the main
+// thread only waits, and those imports are swapped for versions serialized by
+// one lock. Errors are carried back and raised on the main thread afterwards.
+namespace {
+	struct decode_error {
+		int level;
+		std::string message;
+	};
+	
+	std::mutex decode_lock;
+	refimport_t decode_import;
+	
+	void QDECL decode_printf(int level, char const * fmt, ...) {
+		char msg[4096];
+		va_list argptr;
+		va_start(argptr, fmt);
+		Q_vsnprintf(msg, sizeof(msg), fmt, argptr);
+		va_end(argptr);
+		std::lock_guard lock {decode_lock};
+		decode_import.Printf(level, "%s", msg);
+	}
+	
+	[[noreturn]] void QDECL decode_raise(int level, char const * fmt, ...) {
+		char msg[4096];
+		va_list argptr;
+		va_start(argptr, fmt);
+		Q_vsnprintf(msg, sizeof(msg), fmt, argptr);
+		va_end(argptr);
+		throw decode_error { level, msg };
+	}
+	
+	void * decode_z_malloc(int size, memtag_t tag, qboolean zero, int align) {
+		std::lock_guard lock {decode_lock};
+		return decode_import.Z_Malloc(size, tag, zero, align);
+	}
+	
+	void decode_z_free(void * ptr) {
+		std::lock_guard lock {decode_lock};
+		decode_import.Z_Free(ptr);
+	}
+	
+	void * decode_temp_alloc(int size) {
+		std::lock_guard lock {decode_lock};
+		return decode_import.Hunk_AllocateTempMemory(size);
+	}
+	
+	void decode_temp_free(void * ptr) {
+		std::lock_guard lock {decode_lock};
+		decode_import.Hunk_FreeTempMemory(ptr);
+	}
+	
+	long decode_read_file(char const * path, void * * buffer) {
+		std::lock_guard lock {decode_lock};
+		return decode_import.FS_ReadFile(path, buffer);
+	}
+	
+	void decode_free_file(void * buffer) {
+		std::lock_guard lock {decode_lock};
+		decode_import.FS_FreeFile(buffer);
+	}
+	
+	struct decode_import_scope {
+		decode_import_scope() {
+			decode_import = ri;
+			ri.Printf = decode_printf;
+			ri.Error = decode_raise;
+			ri.Z_Malloc = decode_z_malloc;
+			ri.Z_Free = decode_z_free;
+			ri.Hunk_AllocateTempMemory = decode_temp_alloc;
+			ri.Hunk_FreeTempMemory = decode_temp_free;
+			ri.FS_ReadFile = decode_read_file;
+			ri.FS_FreeFile = decode_free_file;
+		}
+		~decode_import_scope() {
+			ri.Printf = decode_import.Printf;
+			ri.Error = decode_import.Error;
+			ri.Z_Malloc = decode_import.Z_Malloc;
+			ri.Z_Free = decode_import.Z_Free;
+			ri.Hunk_AllocateTempMemory = decode_import.Hunk_AllocateTempMemory;
+			ri.Hunk_FreeTempMemory = decode_import.Hunk_FreeTempMemory;
+			ri.FS_ReadFile = decode_import.FS_ReadFile;
+			ri.FS_FreeFile = decode_import.FS_FreeFile;
+		}
+	};
+}
+
 instance::texture_registry::texture_registry() {
 	R_ImageLoader_Init();
 }
@@ -82,31 +193,137 @@ void instance::texture_registry::generate_named_defaults() {
 	lookup["*invalid"] = nullptr;
 }
 
+instance::texture_registry::decoded_image instance::texture_registry::decode(char const * name) {
+	decoded_image image;
+	R_LoadImage(name, &image.data, &image.width, &image.height);
+	if (image.data) image.transparent = image_has_transparency(image.data, static_cast<size_t>(image.width) * image.height);
+	return image;
+}
+
+void instance::texture_registry::decode_parallel(std::vector<istring> const & names, std::vector<decoded_image> & images) {
+	images.clear();
+	images.resize(names.size());
+	
+	TaskCore * taskcore = ri.GetTaskCore ? ri.GetTaskCore() : nullptr;
+	if (!taskcore) {
+		for (size_t i = 0; i < names.size(); i++)
+			images[i] = decode(names[i].c_str());
+		return;
+	}
+	
+	std::atomic_size_t next {0};
+	std::vector<decode_error> errors;
+	{
+		decode_import_scope scope;
+		taskcore->enqueue_fill_wait([&](){
+			for (size_t i = next++; i < names.size(); i = next++) {
+				try {
+					images[i] = decode(names[i].c_str());
+				} catch (decode_error & err) {
+					std::lock_guard lock {decode_lock};
+					errors.emplace_back(std::move(err));
+				}
+			}
+		});
+	}
+	
+	if (errors.size()) {
+		for (decoded_image & image : images)
+			if (image.data) Z_Free(image.data);
+		images.clear();
+		ri.Error(errors[0].level, "%s", errors[0].message.c_str());
+	}
+}
+
+void instance::texture_registry::prefetch(std::vector<istring> const & names) {
+	std::vector<istring> pending;
+	std::unordered_set<istring> seen;
+	for (istring const & name : names) {
+		if (lookup.contains(name) || prefetched.contains(name)) continue;
+		if (seen.insert(name).second) pending.push_back(name);
+	}
+	if (pending.size() < 2) return;
+	
+	std::vector<decoded_image> images;
+	decode_parallel(pending, images);
+	for (size_t i = 0; i < pending.size(); i++)
+		prefetched[pending[i]] = images[i];
+}
+
+void instance::texture_registry::discard_prefetched() {
+	for (auto & [name, image] : prefetched)
+		if (image.data) Z_Free(image.data);
+	prefetched.clear();
+}
+
 q3texture_ptr instance::texture_registry::reg(istring const & name, bool mips) {
 	assert(hw_inst->renderer_initialized);
 	
 	auto iter = lookup.find(name);
 	if (iter != lookup.end()) return iter->second;
 	
-	byte * data;
-	int32_t width, height;
+	decoded_image image;
+	auto pre = prefetched.find(name);
+	if (pre != prefetched.end()) {
+		image = pre->second;
+		prefetched.erase(pre);
+	} else
+		image = decode(name.c_str());
 	
-	R_LoadImage(name.c_str(), &data, &width, &height);
-	if (!data) {
+	if (!image.data) {
 		Com_Printf(S_COLOR_RED "ERROR: Failed to load texture '%s'!\n", name.c_str());
 		return lookup[name] = nullptr;
 	}
 	
-	q3texture_ptr & tex = lookup[name] = make_q3texture(width, height, mips);
-	
-	for (int x = 0; x < width; x++) for (int y = 0; y < height; y++) {
-		byte * pixel = data + (y * width + x) * 4;
-		if (pixel[3] != 0xFF) tex->set_transparent();
-	}
+	q3texture_ptr & tex = lookup[name] = make_q3texture(image.width, image.height, mips);
+	if (image.transparent) tex->set_transparent();
 	
-	tex->upload(width, height, data);
+	tex->upload(image.width, image.height, image.data);
 	tex->generate_mipmaps();
 	
-	Z_Free(data);
+	Z_Free(image.data);
 	return tex;
 }
+
+void instance::texture_registry::decode_benchmark(char const * dir) {
+	std::vector<istring> names;
+	for (char const * ext : { ".jxl", ".png", ".jpg", ".tga" }) {
+		int num;
+		char * * files = ri.FS_ListFiles(dir, ext, &num);
+		for (int i = 0; i < num; i++)
+			names.emplace_back(va("%s/%s", dir, files[i]));
+		ri.FS_FreeFileList(files);
+	}
+	if (names.empty()) {
+		Com_Printf("No images found in '%s'.\n", dir);
+		return;
+	}
+	
+	std::vector<decoded_image> images;
+	int64_t pixels = 0, failed = 0;
+	auto release = [&](){
+		pixels = failed = 0;
+		for (decoded_image & image : images) {
+			if (!image.data) { failed++; continue; }
+			pixels += static_cast<int64_t>(image.width) * image.height;
+			Z_Free(image.data);
+		}
+		images.clear();
+	};
+	
+	// serial first, which also warms the file system for the parallel pass
+	int start = ri.Milliseconds();
+	for (istring const & name : names)
+		images.push_back(decode(name.c_str()));
+	int serial = ri.Milliseconds() - start;
+	release();
+	
+	start = ri.Milliseconds();
+	decode_parallel(names, images);
+	int parallel = ri.Milliseconds() - start;
+	release();
+	
+	Com_Printf("%zu images (%lld failed), %.1f megapixels\n", names.size(), static_cast<long long>(failed), pixels / 1e6);
+	Com_Printf("serial:   %6d ms\n", serial);
+	Com_Printf("parallel: %6d ms (%.2fx on %u threads)\n", parallel, parallel ? static_cast<float>(serial) / parallel : 0.0f, TaskCore::system_ideal_task_count());
+}
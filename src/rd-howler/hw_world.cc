@@ -1,6 +1,8 @@
 #include "hw_local.hh"
 using namespace howler;
 
+#include <bit>
+#include <map>
 #include <stack>
 #include <unordered_set>
 
@@ -95,6 +97,7 @@ void q3world::load(char const * name) {
 	load_lightgridarray();
 	
 	build_world_meshes();
+	build_vis_lists();
 }
 
 //================================================================
@@ -128,75 +131,58 @@ q3world::q3world_draw const & q3world::get_vis_model(refdef_t const & ref) {
 	
 	if (r_viscachesize->integer > 0 && m_vis_cache.size() > static_cast<unsigned>(r_viscachesize->integer)) m_vis_cache.resize(r_viscachesize->integer);
 	
-	std::unordered_set<q3worldsurface const *> marked_surfaces;
+	std::vector<uint64_t> visible((m_vis_surfaces.size() + 63) / 64);
+	auto mark = [&](vis_cluster_t const & vc) {
+		for (uint32_t id : vc.surfaces) visible[id >> 6] |= 1ull << (id & 63);
+	};
 	
 	if (cluster >= 0) {
 		auto cluster_vis = m_vis->cluster(cluster);
-		for (size_t i = m_nodes_leafs_offset; i < m_nodes.size(); i++) {
-			auto const & node = m_nodes[i];
-			if (!node.parent) continue; // non-parented leaf means bmodel
-			std::visit( lambda_visit{
-				[&](std::monostate) {assert(0);},
-				[&](q3worldnode::node_data const &) {},
-				[&](q3worldnode::leaf_data const & data) {
-					if (data.cluster < 0 || data.cluster >= m_vis->header.clusters) return;
-					if (!cluster_vis.can_see(data.cluster)) return;
-					if ((ref.areamask[data.area>>3] & (1<<(data.area&7)))) return;
-					for (auto const & surf : data.surfaces) marked_surfaces.emplace(surf);
-				}
-			}, node.data);
+		for (size_t k = 0; k < m_vis_clusters.size(); k++) {
+			if (static_cast<int32_t>(k) >= m_vis->header.clusters) break;
+			if (!cluster_vis.can_see(k)) continue;
+			for (vis_cluster_t const & vc : m_vis_clusters[k]) {
+				if ((ref.areamask[vc.area>>3] & (1<<(vc.area&7)))) continue;
+				mark(vc);
+			}
 		}
 	} else {
-		for (size_t i = m_nodes_leafs_offset; i < m_nodes.size(); i++) {
-			auto const & node = m_nodes[i];
-			if (!node.parent) continue;
-			std::visit( lambda_visit{
-				[&](std::monostate) {assert(0);},
-				[&](q3worldnode::node_data const &) {},
-				[&](q3worldnode::leaf_data const & data) {
-					if (data.cluster < 0) return;
-					for (auto const & surf : data.surfaces) marked_surfaces.emplace(surf);
-				}
-			}, node.data);
-		}
+		for (auto const & areas : m_vis_clusters)
+			for (vis_cluster_t const & vc : areas) mark(vc);
 	}
 	
 	q3world_draw & world_draw = std::get<1>(*m_vis_cache.emplace(m_vis_cache.begin(), cluster, q3world_draw {make_q3model(), {}}, areamask));
-	std::unordered_map<q3shader_ptr, q3worldmesh_maplit_proto> buckets_maplit;
-	std::unordered_map<q3shader_ptr, q3worldmesh_vertexlit_proto> buckets_vertlit;
-	
-	for (q3worldsurface const * surf : marked_surfaces) {
-		std::visit( lambda_visit {
-			[&](std::monostate const &) {},
-			[&](q3worldmesh_maplit_proto const & proto) {
-				q3worldmesh_maplit_proto & sub = buckets_maplit[surf->shader];
-				sub.append_indicies(proto);
-			},
-			[&](q3worldmesh_vertexlit_proto const & proto) {
-				q3worldmesh_vertexlit_proto & sub = buckets_vertlit[surf->shader];
-				sub.append_indicies(proto);
-			},
-			[&](q3worldmesh_flare const & flare) {
-				world_draw.flares[surf->shader].push_back(flare);
-			}
-		}, surf->proto);
-	}
-	
 	q3model_ptr & model = world_draw.model;
 	
-	for (auto & [shader, proto] : buckets_maplit) {
+	// surfaces are numbered by batch, so walking the set bits in order yields
+	// each batch's visible surfaces as one run
+	std::vector<GLuint> indicies;
+	uint32_t batch = VIS_NO_BATCH;
+	auto flush = [&]() {
+		if (batch == VIS_NO_BATCH || indicies.empty()) return;
 		auto rend = std::make_shared<q3worldrendermesh>();
-		rend->world_mesh = m_world_meshes[shader].maplit;
-		rend->upload_indicies(proto.indicies.data(), proto.indicies.size());
-		model->meshes.emplace_back(shader, rend);
-	}
+		rend->world_mesh = m_vis_batches[batch].world_mesh;
+		rend->upload_indicies(indicies.data(), indicies.size());
+		model->meshes.emplace_back(m_vis_batches[batch].shader, rend);
+		indicies.clear();
+	};
 	
-	for (auto & [shader, proto] : buckets_vertlit) {
-		auto rend = std::make_shared<q3worldrendermesh>();
-		rend->world_mesh = m_world_meshes[shader].vertexlit;
-		rend->upload_indicies(proto.indicies.data(), proto.indicies.size());
-		model->meshes.emplace_back(shader, rend);
+	for (size_t w = 0; w < visible.size(); w++) {
+		for (uint64_t bits = visible[w]; bits; bits &= bits - 1) {
+			vis_surface_t const & vs = m_vis_surfaces[w * 64 + std::countr_zero(bits)];
+			if (vs.batch == VIS_NO_BATCH) {
+				world_draw.flares[vs.surf->shader].push_back(std::get<q3worldmesh_flare>(vs.surf->proto));
+				continue;
+			}
+			if (vs.batch != batch) {
+				flush();
+				batch = vs.batch;
+			}
+			auto const & src = m_vis_batches[batch].indicies;
+			indicies.insert(indicies.end(), src.begin() + vs.first, src.begin() + vs.first + vs.count);
+		}
 	}
+	flush();
 	
 	return world_draw;
 }
@@ -303,6 +289,82 @@ void q3world::build_world_meshes() {
 	}
 }
 
+void q3world::build_vis_lists() {
+	
+	// every drawable surface referenced by a worldspawn leaf
+	std::vector<bool> marked(m_surfaces.size());
+	for (size_t i = m_nodes_leafs_offset; i < m_nodes.size(); i++) {
+		auto const & node = m_nodes[i];
+		if (!node.parent) continue;
+		auto const * data = std::get_if<q3worldnode::leaf_data>(&node.data);
+		if (!data || data->cluster < 0) continue;
+		for (q3worldsurface const * surf : data->surfaces)
+			if (!std::holds_alternative<std::monostate>(surf->proto)) marked[surf - m_surfaces.data()] = true;
+	}
+	
+	// group them into batches by shader and lighting type, flares last
+	std::map<std::pair<q3shader_ptr, bool>, std::vector<q3worldsurface const *>> groups;
+	std::vector<q3worldsurface const *> flares;
+	for (size_t i = 0; i < m_surfaces.size(); i++) {
+		if (!marked[i]) continue;
+		q3worldsurface const & surf = m_surfaces[i];
+		if (std::holds_alternative<q3worldmesh_flare>(surf.proto)) flares.push_back(&surf);
+		else groups[{surf.shader, std::holds_alternative<q3worldmesh_maplit_proto>(surf.proto)}].push_back(&surf);
+	}
+	
+	std::vector<uint32_t> surface_ids(m_surfaces.size(), UINT32_MAX);
+	m_vis_batches.clear();
+	m_vis_surfaces.clear();
+	
+	for (auto const & [key, surfs] : groups) {
+		vis_batch_t & batch = m_vis_batches.emplace_back();
+		batch.shader = key.first;
+		batch.world_mesh = key.second ? m_world_meshes[key.first].maplit : m_world_meshes[key.first].vertexlit;
+		for (q3worldsurface const * surf : surfs) {
+			std::vector<GLuint> const & src = key.second ? std::get<q3worldmesh_maplit_proto>(surf->proto).indicies : std::get<q3worldmesh_vertexlit_proto>(surf->proto).indicies;
+			surface_ids[surf - m_surfaces.data()] = m_vis_surfaces.size();
+			m_vis_surfaces.push_back({surf, static_cast<uint32_t>(m_vis_batches.size() - 1), static_cast<uint32_t>(batch.indicies.size()), static_cast<uint32_t>(src.size())});
+			batch.indicies.insert(batch.indicies.end(), src.begin(), src.end());
+		}
+	}
+	for (q3worldsurface const * surf : flares) {
+		surface_ids[surf - m_surfaces.data()] = m_vis_surfaces.size();
+		m_vis_surfaces.push_back({surf, VIS_NO_BATCH, 0, 0});
+	}
+	
+	// and list them per cluster and area
+	int32_t clusters = m_vis ? m_vis->header.clusters : 0;
+	for (size_t i = m_nodes_leafs_offset; i < m_nodes.size(); i++) {
+		auto const * data = std::get_if<q3worldnode::leaf_data>(&m_nodes[i].data);
+		if (m_nodes[i].parent && data && data->cluster >= clusters) clusters = data->cluster + 1;
+	}
+	m_vis_clusters.clear();
+	m_vis_clusters.resize(clusters);
+	
+	for (size_t i = m_nodes_leafs_offset; i < m_nodes.size(); i++) {
+		auto const & node = m_nodes[i];
+		if (!node.parent) continue;
+		auto const * data = std::get_if<q3worldnode::leaf_data>(&node.data);
+		if (!data || data->cluster < 0) continue;
+		
+		auto & areas = m_vis_clusters[data->cluster];
+		auto area = std::find_if(areas.begin(), areas.end(), [&](vis_cluster_t const & vc){ return vc.area == data->area; });
+		if (area == areas.end()) area = areas.insert(areas.end(), vis_cluster_t { data->area, {} });
+		
+		for (q3worldsurface const * surf : data->surfaces) {
+			uint32_t id = surface_ids[surf - m_surfaces.data()];
+			if (id != UINT32_MAX) area->surfaces.push_back(id);
+		}
+	}
+	
+	for (auto & areas : m_vis_clusters) {
+		for (vis_cluster_t & vc : areas) {
+			std::sort(vc.surfaces.begin(), vc.surfaces.end());
+			vc.surfaces.erase(std::unique(vc.surfaces.begin(), vc.surfaces.end()), vc.surfaces.end());
+		}
+	}
+}
+
 //================================================================
 // SHADERS
 //================================================================
@@ -411,6 +473,25 @@ void q3world::load_surfaces(int32_t idx) {
 	
 	m_surfaces.resize(bsurfs.size());
 	
+	// register the shaders the surfaces use a batch at a time: each batch's images are
+	// decoded on all cores, then uploaded and freed before the next batch is decoded
+	std::vector<istring> shader_names;
+	std::vector<bool> shader_used(m_shaders.size());
+	for (size_t s = 0; s < bsurfs.size(); s++) {
+		int32_t const shader = bsurfs[s].shader;
+		if (shader_used[shader]) continue;
+		shader_used[shader] = true;
+		shader_names.emplace_back(m_shaders[shader].shader);
+	}
+	size_t const batch = instance::texture_registry::prefetch_batch;
+	for (size_t b = 0; b < shader_names.size(); b += batch) {
+		std::vector<istring> names(shader_names.begin() + b, shader_names.begin() + std::min(b + batch, shader_names.size()));
+		hw_inst->shaders.prefetch(names);
+		for (istring const & name : names)
+			hw_inst->shaders.reg(name, true, default_shader_mode::lightmap);
+		hw_inst->textures.discard_prefetched();
+	}
+	
 	for (size_t s = 0; s < bsurfs.size(); s++) {
 		
 		BSP::Surface const & surfi = bsurfs[s];
@@ -46,6 +46,14 @@ static void CMD_screenshot() {
 	hw_inst->screenshot(path);
 }
 
+static void CMD_imagebench() {
+	hw_inst->textures.decode_benchmark(ri.Cmd_Argc() > 1 ? ri.Cmd_Argv(1) : "textures");
+}
+
+static void CMD_drawbench() {
+	hw_inst->draw_benchmark(ri.Cmd_Argc() > 1 ? atoi(ri.Cmd_Argv(1)) : 100);
+}
+
 struct console_command_t {
 	const char	*cmd;
 	xcommand_t	func;
@@ -53,6 +61,8 @@ struct console_command_t {
 
 static constexpr console_command_t commands [] = {
 	{ "lightmap_atlas",			[](){hw_inst->save_lightmap_atlas();} },
+	{ "imagebench",				CMD_imagebench },
+	{ "drawbench",				CMD_drawbench },
 	{ "screenshot",				CMD_screenshot }
 };
 static constexpr size_t commands_num = ARRAY_LEN ( commands );
@@ -23,6 +23,7 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include "qcommon/q_shared.hh"
 
 #include <algorithm>
+#include <bit>
 
 #include "navigator.hh"
 #include "game/g_nav.hh"
@@ -40,11 +41,18 @@ CNavigator		navigator;
 
 cvar_t		*d_altRoutes;
 cvar_t		*d_patched;
+cvar_t		*d_navStats;
+
+//per frame navigator counters, printed by d_navStats
+static int	navFrameCalls;
+static int	navFrameCheckedLookups;
+static int	navFrameEdgeLookups;
 
 void NAV_CvarInit()
 {
 	d_altRoutes = Cvar_Get("d_altRoutes", "0", CVAR_CHEAT);
 	d_patched = Cvar_Get("d_patched", "0", CVAR_CHEAT);
+	d_navStats = Cvar_Get("d_navStats", "0", CVAR_CHEAT);
 }
 
 void NAV_Free()
@@ -571,7 +579,7 @@ Init
 
 void CNavigator::Init( void )
 {
-	if (!d_altRoutes || !d_patched)
+	if (!d_altRoutes || !d_patched || !d_navStats)
 	{
 		NAV_CvarInit();
 	}
@@ -595,7 +603,7 @@ void CNavigator::Free( void )
 	}
 
 	m_nodes.clear();
-	m_edgeLookupMap.clear();
+	m_failedEdgeMasks.clear();
 }
 
 /*
@@ -653,9 +661,10 @@ bool CNavigator::Load( const char *filename, int checksum )
 
 	//read in the failed edges
 	FS_Read( &failedEdges, sizeof( failedEdges ), file );
+	m_failedEdgeMasks.assign( m_nodes.size(), 0 );
 	for ( int j = 0; j < MAX_FAILED_EDGES; j++ )
 	{
-		m_edgeLookupMap.insert(std::pair<int, int>(failedEdges[j].startID, j));
+		LinkFailedEdge( j );
 	}
 
 
@@ -729,6 +738,7 @@ int CNavigator::AddRawPoint( vec3_t point, int flags, int radius )
 	//TODO: Correct stuck waypoints
 
 	STL_INSERT( m_nodes, node );
+	m_failedEdgeMasks.push_back( 0 );
 
 	return node->GetID();
 }
@@ -1326,6 +1336,8 @@ int CNavigator::CollectNearestNodes( vec3_t origin, int radius, int maxCollect,
 
 int CNavigator::GetBestPathBetweenEnts( sharedEntity_t *ent, sharedEntity_t *goal, int flags )
 {
+	navFrameCalls++;
+
 	//Must have nodes
 	if ( m_nodes.size() == 0 )
 		return NODE_NONE;
@@ -1520,6 +1532,8 @@ GetNearestWaypoint
 
 int CNavigator::GetNearestNode( sharedEntity_t *ent, int lastID, int flags, int targetID )
 {
+	navFrameCalls++;
+
 	int	bestNode = NODE_NONE;
 	//Must have nodes
 	if ( m_nodes.size() == 0 )
@@ -1691,10 +1705,34 @@ void CNavigator::ShowPath( int start, int end )
 	}
 }
 
-static std::map<int,byte> CheckedNodes;
+/*
+-------------------------
+Checked nodes
+
+Every entity gets a passed and a failed bit per waypoint. The tables are
+only valid for the frame they were written in, so clearing them every frame
+is a generation bump and an entity's bits are wiped the first time it's set
+in a new frame.
+-------------------------
+*/
+
+#define CHECKED_NODE_WORDS	((MAX_STORED_WAYPOINTS+31)/32)
+
+static uint32_t	checkedNodesPassed[MAX_GENTITIES][CHECKED_NODE_WORDS];
+static uint32_t	checkedNodesFailed[MAX_GENTITIES][CHECKED_NODE_WORDS];
+static int		checkedNodesGeneration[MAX_GENTITIES];
+static int		checkedNodesFrame = 1;
+
 void CNavigator::ClearCheckedNodes( void )
 {
-	CheckedNodes.clear();
+	//called once per game frame
+	if ( d_navStats && d_navStats->integer && ( navFrameCalls || navFrameCheckedLookups || navFrameEdgeLookups ) )
+	{
+		Com_Printf( "nav: %d calls, %d checked node lookups, %d failed edge lookups\n", navFrameCalls, navFrameCheckedLookups, navFrameEdgeLookups );
+	}
+	navFrameCalls = navFrameCheckedLookups = navFrameEdgeLookups = 0;
+
+	checkedNodesFrame++;
 }
 
 byte CNavigator::CheckedNode(int wayPoint,int ent)
@@ -1705,10 +1743,19 @@ byte CNavigator::CheckedNode(int wayPoint,int ent)
 		return CHECKED_NO;
 	}
 	assert(ent>=0&&ent<MAX_GENTITIES);
-	std::map<int,byte>::iterator f=CheckedNodes.find(wayPoint*MAX_GENTITIES+ent);
-	if (f!=CheckedNodes.end())
+	navFrameCheckedLookups++;
+	if ( checkedNodesGeneration[ent] != checkedNodesFrame )
+	{
+		return CHECKED_NO;
+	}
+	const uint32_t bit = 1u << (wayPoint & 31);
+	if ( checkedNodesFailed[ent][wayPoint >> 5] & bit )
 	{
-		return (*f).second;
+		return CHECKED_FAILED;
+	}
+	if ( checkedNodesPassed[ent][wayPoint >> 5] & bit )
+	{
+		return CHECKED_PASSED;
 	}
 	return CHECKED_NO;
 }
@@ -1722,7 +1769,23 @@ void CNavigator::SetCheckedNode(int wayPoint,int ent,byte value)
 	}
 	assert(ent>=0&&ent<MAX_GENTITIES);
 	assert(value==CHECKED_FAILED||value==CHECKED_PASSED);
-	CheckedNodes[wayPoint*MAX_GENTITIES+ent]=value;
+	if ( checkedNodesGeneration[ent] != checkedNodesFrame )
+	{//first node this entity checks this frame
+		memset( checkedNodesPassed[ent], 0, sizeof( checkedNodesPassed[ent] ) );
+		memset( checkedNodesFailed[ent], 0, sizeof( checkedNodesFailed[ent] ) );
+		checkedNodesGeneration[ent] = checkedNodesFrame;
+	}
+	const uint32_t bit = 1u << (wayPoint & 31);
+	if ( value == CHECKED_FAILED )
+	{
+		checkedNodesFailed[ent][wayPoint >> 5] |= bit;
+		checkedNodesPassed[ent][wayPoint >> 5] &= ~bit;
+	}
+	else
+	{
+		checkedNodesPassed[ent][wayPoint >> 5] |= bit;
+		checkedNodesFailed[ent][wayPoint >> 5] &= ~bit;
+	}
 }
 
 #define	CHECK_FAILED_EDGE_INTERVAL	1000
@@ -1865,14 +1928,55 @@ void CNavigator::ClearFailedEdge( failedEdge_t *failedEdge )
 	}
 	*/
 	//clear failedEdge info
+	if ( failedEdge >= failedEdges && failedEdge < failedEdges + MAX_FAILED_EDGES )
+	{
+		UnlinkFailedEdge( failedEdge - failedEdges );
+	}
 	SetEdgeCost( failedEdge->startID, failedEdge->endID, -1 );
 	failedEdge->startID = failedEdge->endID = WAYPOINT_NONE;
 	failedEdge->entID = ENTITYNUM_NONE;
 	failedEdge->checkTime = 0;
 }
 
+/*
+-------------------------
+LinkFailedEdge / UnlinkFailedEdge
+
+Keep the per node failed edge masks in sync with failedEdges so EdgeFailed
+only has to look at the edges both nodes share.
+-------------------------
+*/
+
+void CNavigator::LinkFailedEdge( int edgeNum )
+{
+	const failedEdge_t *failedEdge = &failedEdges[edgeNum];
+
+	if ( failedEdge->startID < 0 || failedEdge->startID >= (int)m_failedEdgeMasks.size()
+		|| failedEdge->endID < 0 || failedEdge->endID >= (int)m_failedEdgeMasks.size() )
+	{
+		return;
+	}
+	m_failedEdgeMasks[failedEdge->startID] |= 1u << edgeNum;
+	m_failedEdgeMasks[failedEdge->endID] |= 1u << edgeNum;
+}
+
+void CNavigator::UnlinkFailedEdge( int edgeNum )
+{
+	const failedEdge_t *failedEdge = &failedEdges[edgeNum];
+
+	if ( failedEdge->startID >= 0 && failedEdge->startID < (int)m_failedEdgeMasks.size() )
+	{
+		m_failedEdgeMasks[failedEdge->startID] &= ~(1u << edgeNum);
+	}
+	if ( failedEdge->endID >= 0 && failedEdge->endID < (int)m_failedEdgeMasks.size() )
+	{
+		m_failedEdgeMasks[failedEdge->endID] &= ~(1u << edgeNum);
+	}
+}
+
 void CNavigator::ClearAllFailedEdges( void )
 {
+	std::fill( m_failedEdgeMasks.begin(), m_failedEdgeMasks.end(), 0 );
 	memset( &failedEdges, WAYPOINT_NONE, sizeof( failedEdges ) );
 	for ( int j = 0; j < MAX_FAILED_EDGES; j++ )
 	{
@@ -1882,51 +1986,29 @@ void CNavigator::ClearAllFailedEdges( void )
 
 int CNavigator::EdgeFailed( int startID, int endID )
 {
-	//OPTIMIZED WAY  (bjg 01/02)
-	//find in lookup map
-	std::pair <EdgeMultimapIt, EdgeMultimapIt> findValue;
-	findValue = m_edgeLookupMap.equal_range(startID);
-	while ( findValue.first != findValue.second )
-	{
-		if( failedEdges[findValue.first->second].endID == endID)
-		{
-			return findValue.first->second;
-		}
-		++findValue.first;
-	}
-	findValue = m_edgeLookupMap.equal_range(endID);
-	while ( findValue.first != findValue.second )
+	navFrameEdgeLookups++;
+
+	if ( startID < 0 || startID >= (int)m_failedEdgeMasks.size()
+		|| endID < 0 || endID >= (int)m_failedEdgeMasks.size() )
 	{
-		if( failedEdges[findValue.first->second].endID == startID)
-		{
-			return findValue.first->second;
-		}
-		++findValue.first;
+		return -1;
 	}
 
-	return -1;
-
-	//Old way (linear search)
-	/*
-	for ( int j = 0; j < MAX_FAILED_EDGES; j++ )
+	//only edges touching both nodes can be this one
+	uint32_t mask = m_failedEdgeMasks[startID] & m_failedEdgeMasks[endID];
+	while ( mask )
 	{
-		if ( failedEdges[j].startID == startID )
-		{
-			if ( failedEdges[j].endID == endID )
-			{
-				return j;
-			}
-		}
-		else if ( failedEdges[j].startID == endID )
+		const int j = std::countr_zero( mask );
+		mask &= mask - 1;
+
+		if ( ( failedEdges[j].startID == startID && failedEdges[j].endID == endID )
+			|| ( failedEdges[j].startID == endID && failedEdges[j].endID == startID ) )
 		{
-			if ( failedEdges[j].endID == startID )
-			{
-				return j;
-			}
+			return j;
 		}
 	}
+
 	return -1;
-	*/
 }
 
 void CNavigator::AddFailedEdge( int entID, int startID, int endID )
@@ -1993,7 +2075,7 @@ void CNavigator::AddFailedEdge( int entID, int startID, int endID )
 			//Check one second from now to see if it's clear
 			failedEdges[j].checkTime = svs.time + CHECK_FAILED_EDGE_INTERVAL + Q_irand( 0, 1000 );
 
-			m_edgeLookupMap.insert(std::pair<int, int>(startID, j));
+			LinkFailedEdge( j );
 
 			/*
 			//DISABLED this for now, makes people stand around too long when
@@ -2267,6 +2349,8 @@ GetBestNodeAltRoute
 
 int CNavigator::GetBestNodeAltRoute( int startID, int endID, int *pathCost, int rejectID )
 {
+	navFrameCalls++;
+
 	//Must have nodes
 	if ( m_nodes.size() == 0 )
 		return WAYPOINT_NONE;
@@ -2383,6 +2467,8 @@ GetBestNode
 
 int CNavigator::GetBestNode( int startID, int endID, int rejectID )
 {
+	navFrameCalls++;
+
 	//Validate the start position
 	if ( ( startID < 0 ) || ( startID >= (int)m_nodes.size() ) )
 		return WAYPOINT_NONE;
@@ -2542,6 +2628,8 @@ GetPathCost
 
 unsigned int CNavigator::GetPathCost( int startID, int endID )
 {
+	navFrameCalls++;
+
 	//Validate the start position
 	if ( ( startID < 0 ) || ( startID >= (int)m_nodes.size() ) )
 		return Q3_INFINITE; // return 0;
@@ -48,8 +48,6 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #define	NAV_HEADER_ID	INT_ID('J','N','V','5')
 #define	NODE_HEADER_ID	INT_ID('N','O','D','E')
 
-typedef std::multimap<int, int> EdgeMultimap;
-typedef EdgeMultimap::iterator EdgeMultimapIt;
 
 
 /*
@@ -141,7 +139,7 @@ protected:
 CNavigator
 -------------------------
 */
-#define MAX_FAILED_EDGES	32
+#define MAX_FAILED_EDGES	32	//one bit per failed edge in the node masks
 class CNavigator
 {
 	typedef	std::vector < CNode * >			node_v;
@@ -249,13 +247,17 @@ protected:
 
 	void	CalculatePath( CNode *node );
 
+	void	LinkFailedEdge( int edgeNum );
+	void	UnlinkFailedEdge( int edgeNum );
+
 	//rww - made failedEdges private as it doesn't seem to need to be public.
 	//And I'd rather shoot myself than have to devise a way of setting/accessing this
 	//array via trap calls.
 	failedEdge_t	failedEdges[MAX_FAILED_EDGES];
 
 	node_v			m_nodes;
-	EdgeMultimap	m_edgeLookupMap;
+	//per node mask of the failedEdges that start or end at the node
+	std::vector<uint32_t>	m_failedEdgeMasks;
 };
 
 //////////////////////////////////////////////////////////////////////
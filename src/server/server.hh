@@ -141,7 +141,11 @@ typedef struct {
 	qboolean	demorecording;
 	qboolean	demowaiting;	// don't record until a non-delta message is sent
 	int			minDeltaFrame;	// the first non-delta frame stored in the demo.  cannot delta against frames older than this
-	fileHandle_t	demofile;
+	FILE		*demofile;		// owned by the demo writer thread once opened, see sv_demo.cc
+	FILE		*indexfile;		// keyframe index written next to the demo
+	int			fileOffset;		// bytes queued to demofile so far
+	int			nextKeyframeTime;	// sv.time at which to force another non-delta snapshot
+	qboolean	keyframe;		// the message being built carries a non-delta snapshot
 	qboolean	isBot;
 	int			botReliableAcknowledge; // for bots, need to maintain a separate reliableAcknowledge to record server messages into the demo file
 } demoInfo_t;
@@ -205,6 +209,8 @@ typedef struct client_s {
 	qboolean		csUpdated[MAX_CONFIGSTRINGS];
 
 	demoInfo_t		demo;
+
+	qboolean		loadTest;	// synthetic player from the loadtest command, see sv_loadtest.cc
 } client_t;
 
 //=============================================================================
@@ -287,6 +293,8 @@ extern	cvar_t	*sv_filterCommands;
 extern	cvar_t	*sv_autoDemo;
 extern	cvar_t	*sv_autoDemoBots;
 extern	cvar_t	*sv_autoDemoMaxMaps;
+extern	cvar_t	*sv_demoKeyframeInterval;
+extern	cvar_t	*sv_loadTestQuit;
 extern	cvar_t	*sv_legacyFixes;
 extern	cvar_t	*sv_banFile;
 
@@ -384,6 +392,37 @@ void SV_AutoRecordDemo( client_t *cl );
 void SV_StopAutoRecordDemos();
 void SV_BeginAutoRecordDemos();
 
+//
+// sv_demo.c
+//
+qboolean SV_DemoOpen( client_t *cl, const char *name, int sequence, msg_t *gamestate );
+void SV_DemoWriteMessage( client_t *cl, msg_t *msg, int headerBytes );
+void SV_DemoClose( client_t *cl );
+qboolean SV_DemoKeyframeDue( client_t *cl );
+void SV_DemoWriterShutdown( void );
+void SV_DemoInfo_f( void );
+
+//
+// sv_loadtest.c
+//
+typedef int64_t loadTestTimer_t;
+
+typedef enum {
+	LOADTEST_GAME,
+	LOADTEST_SEND
+} loadTestStage_t;
+
+loadTestTimer_t SV_LoadTestTimerStart( void );
+void SV_LoadTestTimerStop( loadTestTimer_t start, loadTestStage_t stage );
+void SV_LoadTestCountBytes( int bytes );
+void SV_LoadTestThink( void );
+void SV_LoadTestEndFrame( void );
+void SV_LoadTestStop( qboolean report );
+void SV_LoadTestRecordCmd( client_t *cl, const usercmd_t *cmd );
+void SV_LoadTestRecordStop( void );
+void SV_LoadTest_f( void );
+void SV_LoadTestRecord_f( void );
+
 //
 // sv_snapshot.c
 //
@@ -477,6 +516,9 @@ void SV_Trace( trace_t *results, const vec3_t start, const vec3_t mins, const ve
 void SV_ClipToEntity( trace_t *trace, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int entityNum, int contentmask, int capsule );
 // clip to a specific entity
 
+void SV_TraceWorld( trace_t *results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int contentmask, int capsule );
+// same result as SV_Trace when no entity can be clipped, without looking for any
+
 //
 // sv_net_chan.c
 //
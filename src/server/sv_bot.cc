@@ -206,6 +206,7 @@ int SV_BotAllocateClient(void) {
 	cl->state = CS_ACTIVE;
 	cl->lastPacketTime = svs.time;
 	cl->netchan.remoteAddress.type = NA_BOT;
+	cl->loadTest = qfalse;		// the slot may have held a load test player
 	cl->rate = 16384;
 
 	// cannot start recording auto demos here since bot's name is not set yet
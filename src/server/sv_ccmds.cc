@@ -284,6 +284,7 @@ static void SV_MapRestart_f( void ) {
 		return;
 	}
 
+	SV_LoadTestStop( qtrue );
 	SV_StopAutoRecordDemos();
 
 	// toggle the server bit so clients can detect that a
@@ -1525,34 +1526,18 @@ static void SV_KillServer_f( void ) {
 }
 
 void SV_WriteDemoMessage ( client_t *cl, msg_t *msg, int headerBytes ) {
-	int		len, swlen;
-
-	// write the packet sequence
-	len = cl->netchan.outgoingSequence;
-	swlen = LittleLong( len );
-	FS_Write( &swlen, 4, cl->demo.demofile );
-
-	// skip the packet sequencing information
-	len = msg->cursize - headerBytes;
-	swlen = LittleLong( len );
-	FS_Write( &swlen, 4, cl->demo.demofile );
-	FS_Write( msg->data + headerBytes, len, cl->demo.demofile );
+	// the copy is handed to the demo writer thread, see sv_demo.cc
+	SV_DemoWriteMessage( cl, msg, headerBytes );
 }
 
 void SV_StopRecordDemo( client_t *cl ) {
-	int		len;
-
 	if ( !cl->demo.demorecording ) {
 		Com_Printf( "Client %d is not recording a demo.\n", cl - svs.clients );
 		return;
 	}
 
 	// finish up
-	len = -1;
-	FS_Write (&len, 4, cl->demo.demofile);
-	FS_Write (&len, 4, cl->demo.demofile);
-	FS_FCloseFile (cl->demo.demofile);
-	cl->demo.demofile = 0;
+	SV_DemoClose( cl );
 	cl->demo.demorecording = qfalse;
 	Com_Printf ("Stopped demo for client %d.\n", cl - svs.clients);
 }
@@ -1623,7 +1608,6 @@ void SV_RecordDemo( client_t *cl, char *demoName ) {
 	char		name[MAX_OSPATH];
 	byte		bufData[MAX_MSGLEN];
 	msg_t		msg;
-	int			len;
 
 	if ( cl->demo.demorecording ) {
 		Com_Printf( "Already recording.\n" );
@@ -1635,20 +1619,9 @@ void SV_RecordDemo( client_t *cl, char *demoName ) {
 		return;
 	}
 
-	// open the demo file
 	Q_strncpyz( cl->demo.demoName, demoName, sizeof( cl->demo.demoName ) );
 	Com_sprintf( name, sizeof( name ), "demos/%s.dm_%d", cl->demo.demoName, PROTOCOL_VERSION );
 	Com_Printf( "recording to %s.\n", name );
-	cl->demo.demofile = FS_FOpenFileWrite( name );
-	if ( !cl->demo.demofile ) {
-		Com_Printf ("ERROR: couldn't open.\n");
-		return;
-	}
-	cl->demo.demorecording = qtrue;
-
-	// don't start saving messages until a non-delta compressed message is received
-	cl->demo.demowaiting = qtrue;
-
 	cl->demo.isBot = ( cl->netchan.remoteAddress.type == NA_BOT ) ? qtrue : qfalse;
 	cl->demo.botReliableAcknowledge = cl->reliableSent;
 
@@ -1663,13 +1636,15 @@ void SV_RecordDemo( client_t *cl, char *demoName ) {
 	// finished writing the client packet
 	MSG_WriteByte( &msg, svc_EOF );
 
-	// write it to the demo file
-	len = LittleLong( cl->netchan.outgoingSequence - 1 );
-	FS_Write( &len, 4, cl->demo.demofile );
+	// open the demo file and write it out
+	if ( !SV_DemoOpen( cl, name, cl->netchan.outgoingSequence - 1, &msg ) ) {
+		Com_Printf ("ERROR: couldn't open.\n");
+		return;
+	}
+	cl->demo.demorecording = qtrue;
 
-	len = LittleLong( msg.cursize );
-	FS_Write( &len, 4, cl->demo.demofile );
-	FS_Write( msg.data, msg.cursize, cl->demo.demofile );
+	// don't start saving messages until a non-delta compressed message is received
+	cl->demo.demowaiting = qtrue;
 
 	// the rest of the demo file will be copied from net messages
 }
@@ -1959,6 +1934,9 @@ void SV_AddOperatorCommands( void ) {
 	Cmd_AddCommand ("weapontoggle", SV_WeaponToggle_f, "Toggle g_weaponDisable bits" );
 	Cmd_AddCommand ("svrecord", SV_Record_f, "Record a server-side demo" );
 	Cmd_AddCommand ("svstoprecord", SV_StopRecord_f, "Stop recording a server-side demo" );
+	Cmd_AddCommand ("svdemoinfo", SV_DemoInfo_f, "Show server-side demos being recorded" );
+	Cmd_AddCommand ("loadtest", SV_LoadTest_f, "Benchmark the server with synthetic clients" );
+	Cmd_AddCommand ("loadtestrecord", SV_LoadTestRecord_f, "Record a client's usercmds as a load test script" );
 	Cmd_AddCommand ("sv_rehashbans", SV_RehashBans_f, "Reloads banlist from file" );
 	Cmd_AddCommand ("sv_listbans", SV_ListBans_f, "Lists bans" );
 	Cmd_AddCommand ("sv_banaddr", SV_BanAddr_f, "Bans a user" );
@@ -0,0 +1,309 @@
+/*
+===========================================================================
+Copyright (C) 2013 - 2015, OpenJK contributors
+
+This file is part of the OpenJK source code.
+
+OpenJK is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License version 2 as
+published by the Free Software Foundation.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, see <http://www.gnu.org/licenses/>.
+===========================================================================
+*/
+
+#include "server.hh"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+=============================================================================
+
+Server side demo writer
+
+Every recording client copies its outgoing messages into a shared queue which
+a single background thread drains to disk, so the frame never blocks on file
+io.  A single consumer keeps the writes for each file in submission order.
+Demo files are opened on the main thread with FS_FOpenOSFileWrite, after which
+only the writer touches the stdio file: it writes, and closes it when the
+close job comes up.  The writer never calls back into the file system or the
+console, failures are counted and reported by svdemoinfo.
+
+The queue is capped at DEMO_WRITER_MAX_BYTES.  Dropping a message would break
+the delta chain of the demo, so a full queue makes the frame wait instead.
+
+SV_DemoWriterShutdown drains the queue and stops the thread.  Only SV_DemoOpen
+starts it again; anything queued with no writer running is written at once.
+
+Alongside each demo a small index ("<demo>.idx") is written, one entry per
+non-delta snapshot, so playback tools can seek straight to a keyframe:
+
+4	DEMO_INDEX_IDENT
+4	DEMO_INDEX_VERSION
+then per keyframe:
+4	serverTime
+4	message sequence
+4	byte offset of the message in the demo file
+
+=============================================================================
+*/
+
+#define DEMO_INDEX_IDENT	(('X'<<24)+('D'<<16)+('I'<<8)+'S')
+#define DEMO_INDEX_VERSION	1
+
+#define DEMO_WRITER_MAX_BYTES	(8 * 1024 * 1024)
+
+struct demoWriteJob_t {
+	FILE				*file;
+	std::vector<byte>	data;
+	bool				close;		// fclose the file after writing
+};
+
+static struct {
+	std::mutex						lock;
+	std::condition_variable			wake;
+	std::condition_variable			space;
+	std::deque<demoWriteJob_t>		jobs;
+	std::thread						thread;
+	bool							running;
+	size_t							queuedBytes;
+	int								failures;	// short writes and failed closes
+	int								stalls;		// times the frame waited for queue space
+	int								stallMsec;
+} demoWriter;
+
+static bool SV_DemoWriterRun( demoWriteJob_t &job ) {
+	bool ok = true;
+
+	if ( !job.data.empty() && fwrite( job.data.data(), 1, job.data.size(), job.file ) != job.data.size() ) {
+		ok = false;
+	}
+	if ( job.close && fclose( job.file ) != 0 ) {
+		ok = false;
+	}
+	return ok;
+}
+
+static void SV_DemoWriterThread( void ) {
+	std::unique_lock<std::mutex> lock( demoWriter.lock );
+
+	for ( ;; ) {
+		demoWriter.wake.wait( lock, [] { return !demoWriter.jobs.empty() || !demoWriter.running; } );
+		if ( demoWriter.jobs.empty() ) {
+			break;
+		}
+
+		demoWriteJob_t job = std::move( demoWriter.jobs.front() );
+		demoWriter.jobs.pop_front();
+
+		lock.unlock();
+		const bool ok = SV_DemoWriterRun( job );
+		lock.lock();
+
+		if ( !ok ) {
+			demoWriter.failures++;
+		}
+		demoWriter.queuedBytes -= job.data.size();
+		demoWriter.space.notify_one();
+	}
+}
+
+/*
+==================
+SV_DemoWriterQueue
+
+Copies the buffers into a single job for the writer thread
+==================
+*/
+static void SV_DemoWriterQueue( FILE *f, const void *header, int headerLen, const void *data, int dataLen, bool close = false ) {
+	demoWriteJob_t job;
+	job.file = f;
+	job.close = close;
+	job.data.resize( headerLen + dataLen );
+	if ( headerLen ) {
+		memcpy( job.data.data(), header, headerLen );
+	}
+	if ( dataLen ) {
+		memcpy( job.data.data() + headerLen, data, dataLen );
+	}
+
+	std::unique_lock<std::mutex> lock( demoWriter.lock );
+	if ( !demoWriter.running ) {
+		if ( !SV_DemoWriterRun( job ) ) {
+			demoWriter.failures++;
+		}
+		return;
+	}
+
+	if ( demoWriter.queuedBytes + job.data.size() > DEMO_WRITER_MAX_BYTES && !demoWriter.jobs.empty() ) {
+		const int start = Sys_Milliseconds();
+		demoWriter.space.wait( lock, [&job] {
+			return demoWriter.queuedBytes + job.data.size() <= DEMO_WRITER_MAX_BYTES || demoWriter.jobs.empty(); } );
+		demoWriter.stalls++;
+		demoWriter.stallMsec += Sys_Milliseconds() - start;
+	}
+
+	demoWriter.queuedBytes += job.data.size();
+	demoWriter.jobs.emplace_back( std::move( job ) );
+	demoWriter.wake.notify_one();
+}
+
+static void SV_DemoWriterStart( void ) {
+	std::lock_guard<std::mutex> lock( demoWriter.lock );
+	if ( !demoWriter.running ) {
+		demoWriter.running = true;
+		demoWriter.thread = std::thread( SV_DemoWriterThread );
+	}
+}
+
+/*
+==================
+SV_DemoWriterShutdown
+
+Writes out everything still queued and stops the thread
+==================
+*/
+void SV_DemoWriterShutdown( void ) {
+	{
+		std::lock_guard<std::mutex> lock( demoWriter.lock );
+		if ( !demoWriter.running ) {
+			return;
+		}
+		demoWriter.running = false;
+		demoWriter.wake.notify_one();
+	}
+	demoWriter.thread.join();
+}
+
+/*
+==================
+SV_DemoOpen
+
+Opens the demo and its keyframe index and queues the gamestate message
+==================
+*/
+qboolean SV_DemoOpen( client_t *cl, const char *name, int sequence, msg_t *gamestate ) {
+	int header[2];
+
+	cl->demo.demofile = FS_FOpenOSFileWrite( name );
+	if ( !cl->demo.demofile ) {
+		return qfalse;
+	}
+	cl->demo.indexfile = FS_FOpenOSFileWrite( va( "%s.idx", name ) );
+	cl->demo.fileOffset = 0;
+	cl->demo.keyframe = qfalse;
+	cl->demo.nextKeyframeTime = 0;
+
+	SV_DemoWriterStart();
+
+	if ( cl->demo.indexfile ) {
+		header[0] = LittleLong( DEMO_INDEX_IDENT );
+		header[1] = LittleLong( DEMO_INDEX_VERSION );
+		SV_DemoWriterQueue( cl->demo.indexfile, header, sizeof( header ), NULL, 0 );
+	}
+
+	header[0] = LittleLong( sequence );
+	header[1] = LittleLong( gamestate->cursize );
+	SV_DemoWriterQueue( cl->demo.demofile, header, sizeof( header ), gamestate->data, gamestate->cursize );
+	cl->demo.fileOffset += sizeof( header ) + gamestate->cursize;
+
+	return qtrue;
+}
+
+/*
+==================
+SV_DemoWriteMessage
+
+Queues a copy of an outgoing message, indexing it when it carried a non-delta snapshot
+==================
+*/
+void SV_DemoWriteMessage( client_t *cl, msg_t *msg, int headerBytes ) {
+	int header[3];
+	int len = msg->cursize - headerBytes;
+
+	if ( cl->demo.keyframe && cl->demo.indexfile ) {
+		header[0] = LittleLong( sv.time );
+		header[1] = LittleLong( cl->netchan.outgoingSequence );
+		header[2] = LittleLong( cl->demo.fileOffset );
+		SV_DemoWriterQueue( cl->demo.indexfile, header, sizeof( header ), NULL, 0 );
+	}
+	cl->demo.keyframe = qfalse;
+
+	header[0] = LittleLong( cl->netchan.outgoingSequence );
+	header[1] = LittleLong( len );
+	SV_DemoWriterQueue( cl->demo.demofile, header, 2 * sizeof( int ), msg->data + headerBytes, len );
+	cl->demo.fileOffset += 2 * sizeof( int ) + len;
+}
+
+/*
+==================
+SV_DemoClose
+
+Queues the end marker and hands both files to the writer to close
+==================
+*/
+void SV_DemoClose( client_t *cl ) {
+	int trailer[2] = { -1, -1 };
+
+	SV_DemoWriterQueue( cl->demo.demofile, trailer, sizeof( trailer ), NULL, 0, true );
+	cl->demo.demofile = NULL;
+	if ( cl->demo.indexfile ) {
+		SV_DemoWriterQueue( cl->demo.indexfile, NULL, 0, NULL, 0, true );
+		cl->demo.indexfile = NULL;
+	}
+}
+
+/*
+==================
+SV_DemoKeyframeDue
+
+True when the recording should be given a fresh non-delta snapshot
+==================
+*/
+qboolean SV_DemoKeyframeDue( client_t *cl ) {
+	if ( !cl->demo.demorecording || cl->demo.demowaiting || sv_demoKeyframeInterval->integer <= 0 ) {
+		return qfalse;
+	}
+	return ( sv.time >= cl->demo.nextKeyframeTime ) ? qtrue : qfalse;
+}
+
+void SV_DemoInfo_f( void ) {
+	size_t queuedBytes, queuedJobs;
+	int failures, stalls, stallMsec;
+	int recording = 0;
+
+	if ( !com_sv_running->integer ) {
+		Com_Printf( "Server is not running.\n" );
+		return;
+	}
+
+	for ( int i = 0; i < sv_maxclients->integer; i++ ) {
+		client_t *cl = &svs.clients[i];
+		if ( !cl->demo.demorecording ) {
+			continue;
+		}
+		Com_Printf( "%2d: %s (%d KB)\n", i, cl->demo.demoName, cl->demo.fileOffset / 1024 );
+		recording++;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock( demoWriter.lock );
+		queuedBytes = demoWriter.queuedBytes;
+		queuedJobs = demoWriter.jobs.size();
+		failures = demoWriter.failures;
+		stalls = demoWriter.stalls;
+		stallMsec = demoWriter.stallMsec;
+	}
+	Com_Printf( "%d demos recording, %d writes (%d KB) pending\n", recording, (int)queuedJobs, (int)( queuedBytes / 1024 ) );
+	Com_Printf( "%d stalls on a full queue (%d ms), %d failed writes\n", stalls, stallMsec, failures );
+}
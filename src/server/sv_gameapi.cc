@@ -1940,6 +1940,8 @@ void SV_BindGame( void ) {
 	gi.G2API_GetSurfaceName					= SV_G2API_GetSurfaceName;
 	
 	gi.Model_LoadObj 						= Model_LoadObj;
+	gi.Cvar_ChangeFeed						= Cvar_ChangeFeed;
+	gi.TraceWorld							= SV_TraceWorld;
 
 	GetGameAPI = (GetGameAPI_t)gvm->GetModuleAPI;
 	ret = GetGameAPI( GAME_API_VERSION, &gi );
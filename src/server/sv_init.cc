@@ -453,6 +453,7 @@ void SV_SpawnServer( char *server, qboolean killBots, ForceReload_e eForceReload
 	char		systemInfo[16384];
 	const char	*p;
 
+	SV_LoadTestStop( qtrue );
 	SV_StopAutoRecordDemos();
 
 	SV_SendMapChange();
@@ -938,6 +939,7 @@ static void SV_InitRef( void ) {
 	
 	ri.PD_Store = PD_Store;
 	ri.PD_Load = PD_Load;
+	ri.GetTaskCore = *[](){ return com_taskcore.get(); };
 
 	ret = GetRefAPI( REF_API_VERSION, &ri );
 	typedef void(*G2_Init_f)(refimport_t * ri, refexport_t * re);
@@ -1038,6 +1040,8 @@ void SV_Init (void) {
 	sv_autoDemo = Cvar_Get( "sv_autoDemo", "0", CVAR_ARCHIVE_ND | CVAR_SERVERINFO, "Automatically take server-side demos" );
 	sv_autoDemoBots = Cvar_Get( "sv_autoDemoBots", "0", CVAR_ARCHIVE_ND, "Record server-side demos for bots" );
 	sv_autoDemoMaxMaps = Cvar_Get( "sv_autoDemoMaxMaps", "0", CVAR_ARCHIVE_ND );
+	sv_loadTestQuit = Cvar_Get( "sv_loadTestQuit", "0", 0, "Quit once a timed load test has printed its results" );
+	sv_demoKeyframeInterval = Cvar_Get( "sv_demoKeyframeInterval", "0", CVAR_ARCHIVE_ND, "Milliseconds between forced non-delta snapshots in server-side demos, 0 to disable" );
 
 	sv_legacyFixes = Cvar_Get( "sv_legacyFixes", "1", CVAR_ARCHIVE );
 
@@ -1109,10 +1113,22 @@ void SV_Shutdown( char *finalmsg )
 
 //	Com_Printf( "----- Server Shutdown -----\n" );
 
+	SV_LoadTestStop( qfalse );
+	SV_LoadTestRecordStop();
+
 	if ( svs.clients && !com_errorEntered ) {
 		SV_FinalMessage( finalmsg );
 	}
 
+	// finish any recordings before the demo writer goes away
+	if ( svs.clients ) {
+		for ( int i = 0; i < sv_maxclients->integer; i++ ) {
+			if ( svs.clients[i].demo.demorecording ) {
+				SV_StopRecordDemo( &svs.clients[i] );
+			}
+		}
+	}
+	SV_DemoWriterShutdown();
 	SV_RemoveOperatorCommands();
 	SV_MasterShutdown();
 	SV_ChallengeShutdown();
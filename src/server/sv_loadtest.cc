@@ -0,0 +1,460 @@
+/*
+===========================================================================
+Copyright (C) 2013 - 2015, OpenJK contributors
+
+This file is part of the OpenJK source code.
+
+OpenJK is free software; you can redistribute it and/or modify it
+under the terms of the GNU General Public License version 2 as
+published by the Free Software Foundation.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program; if not, see <http://www.gnu.org/licenses/>.
+===========================================================================
+*/
+
+#include "server.hh"
+#include "sv_gameapi.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+/*
+=============================================================================
+
+Synthetic load test
+
+"loadtest <clients> [seconds] [script]" fills server slots with synthetic
+players.  They are connected to the game as ordinary (non-bot) clients, so
+they run through ClientConnect/ClientBegin/ClientThink and get full
+snapshots built, delta compressed and written every frame.  Like bots they
+have no network connection: their messages are measured and discarded and
+every snapshot and reliable command is treated as acknowledged at once.
+
+Usercmds are either generated (run and turn, jump, fire) or replayed from
+"loadtest/<script>.ucmd", recorded from a real player with
+"loadtestrecord <client> <script>".
+
+When the test ends the per frame cost of GVM_RunFrame and
+SV_SendClientMessages, plus the bytes written, is printed as percentiles.
+With sv_loadTestQuit set the process exits afterwards, for unattended runs.
+
+=============================================================================
+*/
+
+struct loadTestFrame_t {
+	int		gameUsec;
+	int		sendUsec;
+	int		bytes;
+};
+
+static struct {
+	qboolean						active;
+	int								numClients;
+	int								clientNums[MAX_CLIENTS];
+	int								startTime;
+	int								endTime;
+	int								frameNum;
+	loadTestFrame_t					frame;
+	std::vector<loadTestFrame_t>	frames;
+	std::vector<usercmd_t>			script;
+} loadTest;
+
+static struct {
+	int				clientNum;
+	fileHandle_t	file;
+	int				numCmds;
+} loadTestRecord = { -1, 0, 0 };
+
+static int64_t SV_LoadTestClock( void ) {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+loadTestTimer_t SV_LoadTestTimerStart( void ) {
+	return loadTest.active ? SV_LoadTestClock() : 0;
+}
+
+void SV_LoadTestTimerStop( loadTestTimer_t start, loadTestStage_t stage ) {
+	if ( !loadTest.active || !start ) {
+		return;
+	}
+
+	const int usec = (int)( ( SV_LoadTestClock() - start ) / 1000 );
+	if ( stage == LOADTEST_GAME ) {
+		loadTest.frame.gameUsec += usec;
+	} else {
+		loadTest.frame.sendUsec += usec;
+	}
+}
+
+void SV_LoadTestCountBytes( int bytes ) {
+	if ( loadTest.active ) {
+		loadTest.frame.bytes += bytes;
+	}
+}
+
+// the slot may have been kicked and reused by a real player or bot
+static qboolean SV_LoadTestOwnsClient( client_t *cl ) {
+	return ( cl->state >= CS_CONNECTED && cl->loadTest ) ? qtrue : qfalse;
+}
+
+/*
+==================
+SV_LoadTestLoadScript
+==================
+*/
+static qboolean SV_LoadTestLoadScript( const char *name ) {
+	char		*buffer;
+	const char	*line;
+	int			v[10];
+
+	loadTest.script.clear();
+
+	if ( FS_ReadFile( va( "loadtest/%s.ucmd", name ), (void **)&buffer ) < 0 ) {
+		Com_Printf( "Couldn't load loadtest/%s.ucmd\n", name );
+		return qfalse;
+	}
+
+	for ( line = buffer; line && *line; ) {
+		if ( sscanf( line, "%d %d %d %d %d %d %d %d %d %d", &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &v[6], &v[7], &v[8], &v[9] ) == 10 ) {
+			usercmd_t cmd = {};
+			cmd.angles[0] = v[0];
+			cmd.angles[1] = v[1];
+			cmd.angles[2] = v[2];
+			cmd.buttons = v[3];
+			cmd.weapon = (byte)v[4];
+			cmd.forcesel = (byte)v[5];
+			cmd.invensel = (byte)v[6];
+			cmd.forwardmove = (signed char)v[7];
+			cmd.rightmove = (signed char)v[8];
+			cmd.upmove = (signed char)v[9];
+			loadTest.script.push_back( cmd );
+		}
+		line = strchr( line, '\n' );
+		if ( line ) {
+			line++;
+		}
+	}
+	FS_FreeFile( buffer );
+
+	if ( loadTest.script.empty() ) {
+		Com_Printf( "loadtest/%s.ucmd has no usercmds\n", name );
+		return qfalse;
+	}
+	return qtrue;
+}
+
+/*
+==================
+SV_LoadTestConnect
+
+Connects one synthetic player into a free slot, returns the client number or -1
+==================
+*/
+static int SV_LoadTestConnect( int index ) {
+	client_t	*cl;
+	char		*denied;
+	int			i;
+
+	for ( i = 0, cl = svs.clients; i < sv_maxclients->integer; i++, cl++ ) {
+		if ( cl->state == CS_FREE ) {
+			break;
+		}
+	}
+	if ( i == sv_maxclients->integer ) {
+		return -1;
+	}
+
+	Com_Memset( cl, 0, sizeof( *cl ) );
+	cl->gentity = SV_GentityNum( i );
+	cl->gentity->s.number = i;
+	cl->netchan.remoteAddress.type = NA_BOT;
+	cl->demo.isBot = qtrue;		// delta against the previous frame, never transmit
+	cl->loadTest = qtrue;		// but unlike bots, build and write every snapshot
+	Com_sprintf( cl->userinfo, sizeof( cl->userinfo ),
+		"\\name\\loadtest%d\\ip\\localhost\\rate\\90000\\snaps\\%d\\model\\kyle/default", index, sv_fps->integer );
+
+	denied = GVM_ClientConnect( i, qtrue, qfalse );
+	if ( denied ) {
+		Com_Printf( "loadtest: client %d denied: %s\n", index, denied );
+		cl->state = CS_FREE;
+		return -1;
+	}
+	SV_UserinfoChanged( cl );
+
+	cl->state = CS_PRIMED;
+	cl->lastPacketTime = svs.time;
+	cl->lastConnectTime = svs.time;
+	SV_ClientEnterWorld( cl, NULL );
+
+	return i;
+}
+
+/*
+==================
+SV_LoadTestBuildCmd
+==================
+*/
+static void SV_LoadTestBuildCmd( int index, usercmd_t *cmd ) {
+	const int frame = loadTest.frameNum + index * 37;
+
+	if ( !loadTest.script.empty() ) {
+		*cmd = loadTest.script[frame % loadTest.script.size()];
+	} else {
+		Com_Memset( cmd, 0, sizeof( *cmd ) );
+		cmd->angles[YAW] = ANGLE2SHORT( (float)( frame * ( 2 + index % 5 ) % 360 ) );
+		cmd->forwardmove = 127;
+		cmd->rightmove = ( frame / 40 ) & 1 ? 64 : -64;
+		if ( frame % 120 < 5 ) {
+			cmd->upmove = 127;
+		}
+		if ( frame % 90 < 30 ) {
+			cmd->buttons |= BUTTON_ATTACK;
+		}
+	}
+	cmd->serverTime = sv.time;
+}
+
+/*
+==================
+SV_LoadTestThink
+
+Feeds every synthetic player a usercmd, called once per server frame
+==================
+*/
+void SV_LoadTestThink( void ) {
+	usercmd_t cmd;
+
+	if ( !loadTest.active ) {
+		return;
+	}
+
+	for ( int i = 0; i < loadTest.numClients; i++ ) {
+		client_t *cl = &svs.clients[loadTest.clientNums[i]];
+		if ( cl->state != CS_ACTIVE || !SV_LoadTestOwnsClient( cl ) ) {
+			continue;
+		}
+
+		// behave like a client that acks everything immediately
+		cl->lastPacketTime = svs.time;
+		cl->reliableAcknowledge = cl->reliableSent;
+
+		SV_LoadTestBuildCmd( i, &cmd );
+		SV_ClientThink( cl, &cmd );
+	}
+}
+
+static void SV_LoadTestPrintStat( const char *label, std::vector<int> &values, const char *unit ) {
+	if ( values.empty() ) {
+		return;
+	}
+
+	std::sort( values.begin(), values.end() );
+	int64_t total = 0;
+	for ( int value : values ) {
+		total += value;
+	}
+
+	const size_t n = values.size();
+	Com_Printf( "%-22s mean %8d  p50 %8d  p90 %8d  p99 %8d  max %8d %s\n", label, (int)( total / (int64_t)n ),
+		values[n / 2], values[n * 90 / 100], values[n * 99 / 100], values[n - 1], unit );
+}
+
+static void SV_LoadTestReport( void ) {
+	std::vector<int> game, send, bytes;
+
+	game.reserve( loadTest.frames.size() );
+	send.reserve( loadTest.frames.size() );
+	bytes.reserve( loadTest.frames.size() );
+	for ( const loadTestFrame_t &frame : loadTest.frames ) {
+		game.push_back( frame.gameUsec );
+		send.push_back( frame.sendUsec );
+		bytes.push_back( frame.bytes );
+	}
+
+	Com_Printf( "----- Load test: %d clients, %d frames, %.1f seconds -----\n",
+		loadTest.numClients, (int)loadTest.frames.size(), ( svs.time - loadTest.startTime ) / 1000.0f );
+	SV_LoadTestPrintStat( "GVM_RunFrame", game, "usec" );
+	SV_LoadTestPrintStat( "SV_SendClientMessages", send, "usec" );
+	SV_LoadTestPrintStat( "bytes sent", bytes, "bytes" );
+}
+
+/*
+==================
+SV_LoadTestEndFrame
+
+Stores the frame's sample and finishes the test when its time is up
+==================
+*/
+void SV_LoadTestEndFrame( void ) {
+	if ( !loadTest.active ) {
+		return;
+	}
+
+	loadTest.frames.push_back( loadTest.frame );
+	loadTest.frame = {};
+	loadTest.frameNum++;
+
+	if ( loadTest.endTime && svs.time >= loadTest.endTime ) {
+		SV_LoadTestStop( qtrue );
+		if ( sv_loadTestQuit->integer ) {
+			Cbuf_AddText( "quit\n" );
+		}
+	}
+}
+
+/*
+==================
+SV_LoadTestStop
+
+Drops the synthetic players, optionally printing the results gathered so far
+==================
+*/
+void SV_LoadTestStop( qboolean report ) {
+	if ( !loadTest.active ) {
+		return;
+	}
+	loadTest.active = qfalse;
+
+	if ( report ) {
+		SV_LoadTestReport();
+	}
+
+	for ( int i = 0; i < loadTest.numClients; i++ ) {
+		client_t *cl = &svs.clients[loadTest.clientNums[i]];
+		if ( SV_LoadTestOwnsClient( cl ) ) {
+			SV_DropClient( cl, "load test finished" );
+		}
+	}
+
+	loadTest.numClients = 0;
+	loadTest.frames.clear();
+	loadTest.frames.shrink_to_fit();
+	loadTest.script.clear();
+}
+
+void SV_LoadTest_f( void ) {
+	int numClients, seconds;
+
+	if ( !com_sv_running->integer ) {
+		Com_Printf( "Server is not running.\n" );
+		return;
+	}
+
+	if ( Cmd_Argc() == 2 && !Q_stricmp( Cmd_Argv( 1 ), "stop" ) ) {
+		SV_LoadTestStop( qtrue );
+		return;
+	}
+
+	if ( Cmd_Argc() < 2 ) {
+		Com_Printf( "Usage: loadtest <clients> [seconds] [script]\n       loadtest stop\n" );
+		return;
+	}
+
+	if ( loadTest.active ) {
+		Com_Printf( "A load test is already running.\n" );
+		return;
+	}
+
+	numClients = Com_Clampi( 1, MAX_CLIENTS, atoi( Cmd_Argv( 1 ) ) );
+	seconds = Cmd_Argc() > 2 ? atoi( Cmd_Argv( 2 ) ) : 0;
+
+	if ( Cmd_Argc() > 3 && !SV_LoadTestLoadScript( Cmd_Argv( 3 ) ) ) {
+		return;
+	}
+
+	loadTest.numClients = 0;
+	for ( int i = 0; i < numClients; i++ ) {
+		const int clientNum = SV_LoadTestConnect( i );
+		if ( clientNum < 0 ) {
+			break;
+		}
+		loadTest.clientNums[loadTest.numClients++] = clientNum;
+	}
+
+	if ( !loadTest.numClients ) {
+		Com_Printf( "No free client slots for the load test.\n" );
+		loadTest.script.clear();
+		return;
+	}
+
+	loadTest.active = qtrue;
+	loadTest.startTime = svs.time;
+	loadTest.endTime = seconds > 0 ? svs.time + seconds * 1000 : 0;
+	loadTest.frameNum = 0;
+	loadTest.frame = {};
+	loadTest.frames.clear();
+
+	Com_Printf( "Load test started with %d synthetic clients%s.\n", loadTest.numClients,
+		seconds > 0 ? va( " for %d seconds", seconds ) : "" );
+}
+
+/*
+==================
+SV_LoadTestRecordCmd
+
+Appends a real player's usercmd to the script being recorded
+==================
+*/
+void SV_LoadTestRecordCmd( client_t *cl, const usercmd_t *cmd ) {
+	if ( !loadTestRecord.file || cl - svs.clients != loadTestRecord.clientNum ) {
+		return;
+	}
+
+	FS_Printf( loadTestRecord.file, "%d %d %d %d %d %d %d %d %d %d\n",
+		cmd->angles[0], cmd->angles[1], cmd->angles[2], cmd->buttons, cmd->weapon, cmd->forcesel, cmd->invensel,
+		cmd->forwardmove, cmd->rightmove, cmd->upmove );
+	loadTestRecord.numCmds++;
+}
+
+void SV_LoadTestRecordStop( void ) {
+	if ( !loadTestRecord.file ) {
+		return;
+	}
+
+	FS_FCloseFile( loadTestRecord.file );
+	Com_Printf( "Recorded %d usercmds.\n", loadTestRecord.numCmds );
+	loadTestRecord.file = 0;
+	loadTestRecord.clientNum = -1;
+}
+
+void SV_LoadTestRecord_f( void ) {
+	int clientNum;
+
+	if ( !com_sv_running->integer ) {
+		Com_Printf( "Server is not running.\n" );
+		return;
+	}
+
+	if ( Cmd_Argc() == 2 && !Q_stricmp( Cmd_Argv( 1 ), "stop" ) ) {
+		SV_LoadTestRecordStop();
+		return;
+	}
+
+	if ( Cmd_Argc() != 3 ) {
+		Com_Printf( "Usage: loadtestrecord <client> <script>\n       loadtestrecord stop\n" );
+		return;
+	}
+
+	clientNum = atoi( Cmd_Argv( 1 ) );
+	if ( clientNum < 0 || clientNum >= sv_maxclients->integer || svs.clients[clientNum].state != CS_ACTIVE ) {
+		Com_Printf( "Client %d is not active.\n", clientNum );
+		return;
+	}
+
+	SV_LoadTestRecordStop();
+	loadTestRecord.file = FS_FOpenFileWrite( va( "loadtest/%s.ucmd", Cmd_Argv( 2 ) ) );
+	if ( !loadTestRecord.file ) {
+		Com_Printf( "ERROR: couldn't open.\n" );
+		return;
+	}
+	loadTestRecord.clientNum = clientNum;
+	loadTestRecord.numCmds = 0;
+	Com_Printf( "Recording usercmds of client %d to loadtest/%s.ucmd.\n", clientNum, Cmd_Argv( 2 ) );
+}
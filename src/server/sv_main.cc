@@ -67,6 +67,8 @@ cvar_t	*sv_filterCommands; // strict filtering on commands (1: strip ['\r', '\n'
 cvar_t	*sv_autoDemo;
 cvar_t	*sv_autoDemoBots;
 cvar_t	*sv_autoDemoMaxMaps;
+cvar_t	*sv_demoKeyframeInterval;
+cvar_t	*sv_loadTestQuit;
 cvar_t	*sv_legacyFixes;
 cvar_t	*sv_banFile;
 
@@ -461,6 +463,170 @@ qboolean SVC_RateLimitAddress( netadr_t from, int burst, int period ) {
 	return SVC_RateLimit( bucket, burst, period );
 }
 
+/*
+=============================================================================
+
+Cached query responses
+
+The bulk of the getinfo and getstatus responses only changes when cvars,
+clients or scores do, so it is built at most once per server frame (or after
+an rcon command) and a query is answered by copying it around the echoed
+challenge.
+
+=============================================================================
+*/
+
+static struct {
+	int		time = -1;		// svs.time the responses were built for, -1 when invalid
+	int		serverId;
+
+	char	info[MAX_INFO_STRING];	// everything but the challenge
+	int		infoLength;
+
+	char	serverInfo[MAX_INFO_STRING];
+	int		serverInfoLength;
+	char	players[MAX_MSGLEN];
+	int		playersLength;
+} svQueryCache;
+
+/*
+================
+SV_InvalidateQueryCache
+================
+*/
+static void SV_InvalidateQueryCache( void ) {
+	svQueryCache.time = -1;
+}
+
+static void SV_BuildQueryCache( void ) {
+	int		i, count, humans, wDisable;
+	char	*gamedir;
+	char	player[1024];
+	char	*infostring = svQueryCache.info;
+	client_t	*cl;
+	playerState_t	*ps;
+	int		playerLength;
+
+	if ( svQueryCache.time == svs.time && svQueryCache.serverId == sv.serverId ) {
+		return;
+	}
+	svQueryCache.time = svs.time;
+	svQueryCache.serverId = sv.serverId;
+
+	// getstatus: serverinfo followed by one line per player
+	Q_strncpyz( svQueryCache.serverInfo, Cvar_InfoString( CVAR_SERVERINFO ), sizeof( svQueryCache.serverInfo ) );
+	Info_RemoveKey( svQueryCache.serverInfo, "challenge" );
+	svQueryCache.serverInfoLength = strlen( svQueryCache.serverInfo );
+
+	svQueryCache.players[0] = 0;
+	svQueryCache.playersLength = 0;
+
+	for (i=0 ; i < sv_maxclients->integer ; i++) {
+		cl = &svs.clients[i];
+		if ( cl->state >= CS_CONNECTED ) {
+			ps = SV_GameClientNum( i );
+			Com_sprintf (player, sizeof(player), "%i %i \"%s\"\n",
+				ps->persistant[PERS_SCORE], cl->ping, cl->name);
+			playerLength = strlen(player);
+			if (svQueryCache.playersLength + playerLength >= (int)sizeof(svQueryCache.players) ) {
+				break;		// can't hold any more
+			}
+			strcpy (svQueryCache.players + svQueryCache.playersLength, player);
+			svQueryCache.playersLength += playerLength;
+		}
+	}
+
+	// getinfo: don't count privateclients
+	count = humans = 0;
+	for ( i = sv_privateClients->integer ; i < sv_maxclients->integer ; i++ ) {
+		if ( svs.clients[i].state >= CS_CONNECTED ) {
+			count++;
+			if ( svs.clients[i].netchan.remoteAddress.type != NA_BOT ) {
+				humans++;
+			}
+		}
+	}
+
+	infostring[0] = 0;
+
+	Info_SetValueForKey( infostring, "protocol", va("%i", PROTOCOL_VERSION) );
+	Info_SetValueForKey( infostring, "hostname", sv_hostname->string );
+	Info_SetValueForKey( infostring, "mapname", sv_mapname->string );
+	Info_SetValueForKey( infostring, "clients", va("%i", count) );
+	Info_SetValueForKey( infostring, "g_humanplayers", va("%i", humans) );
+	Info_SetValueForKey( infostring, "sv_maxclients",
+		va("%i", sv_maxclients->integer - sv_privateClients->integer ) );
+	Info_SetValueForKey( infostring, "gametype", va("%i", sv_gametype->integer ) );
+	Info_SetValueForKey( infostring, "needpass", va("%i", sv_needpass->integer ) );
+	Info_SetValueForKey( infostring, "truejedi", va("%i", Cvar_VariableIntegerValue( "g_jediVmerc" ) ) );
+	if ( sv_gametype->integer == GT_DUEL || sv_gametype->integer == GT_POWERDUEL )
+	{
+		wDisable = Cvar_VariableIntegerValue( "g_duelWeaponDisable" );
+	}
+	else
+	{
+		wDisable = Cvar_VariableIntegerValue( "g_weaponDisable" );
+	}
+	Info_SetValueForKey( infostring, "wdisable", va("%i", wDisable ) );
+	Info_SetValueForKey( infostring, "fdisable", va("%i", Cvar_VariableIntegerValue( "g_forcePowerDisable" ) ) );
+	//Info_SetValueForKey( infostring, "pure", va("%i", sv_pure->integer ) );
+	Info_SetValueForKey( infostring, "autodemo", va("%i", sv_autoDemo->integer ) );
+
+	if( sv_minPing->integer ) {
+		Info_SetValueForKey( infostring, "minPing", va("%i", sv_minPing->integer) );
+	}
+	if( sv_maxPing->integer ) {
+		Info_SetValueForKey( infostring, "maxPing", va("%i", sv_maxPing->integer) );
+	}
+	gamedir = Cvar_VariableString( "fs_game" );
+	if( *gamedir ) {
+		Info_SetValueForKey( infostring, "game", gamedir );
+	}
+	svQueryCache.infoLength = strlen( infostring );
+}
+
+/*
+================
+SV_FormatChallenge
+
+Writes the "\challenge\<arg>" pair the way Info_SetValueForKey would have
+added it to an info string of infoLength, or nothing if it would be refused
+================
+*/
+static int SV_FormatChallenge( char *out, int outSize, const char *challenge, int infoLength ) {
+	const int len = strlen( challenge );
+
+	if ( !len || strpbrk( challenge, "\\;\"" ) ) {
+		return 0;
+	}
+	if ( len + (int)strlen( "\\challenge\\" ) + infoLength >= MAX_INFO_STRING ) {
+		return 0;
+	}
+	return Com_sprintf( out, outSize, "\\challenge\\%s", challenge );
+}
+
+/*
+================
+SV_SendQueryResponse
+
+Assembles an out of band packet from pieces, truncating like NET_OutOfBandPrint
+================
+*/
+static void SV_SendQueryResponse( netadr_t from, const char **pieces, const int *lengths, int numPieces ) {
+	static char	packet[MAX_MSGLEN];
+	int		length = 4;
+
+	memset( packet, 0xff, 4 );
+	for ( int i = 0; i < numPieces; i++ ) {
+		const int copy = Q_min( lengths[i], (int)sizeof( packet ) - 1 - length );
+		memcpy( packet + length, pieces[i], copy );
+		length += copy;
+	}
+	packet[length] = 0;
+
+	NET_SendPacket( NS_SERVER, length, packet, from );
+}
+
 /*
 ================
 SVC_Status
@@ -471,14 +637,7 @@ the simple info query.
 ================
 */
 void SVC_Status( netadr_t from ) {
-	char	player[1024];
-	char	status[MAX_MSGLEN];
-	int		i;
-	client_t	*cl;
-	playerState_t	*ps;
-	int		statusLength;
-	int		playerLength;
-	char	infostring[MAX_INFO_STRING];
+	char	challenge[160];
 
 	// ignore if we are in single player
 	/*
@@ -507,31 +666,14 @@ void SVC_Status( netadr_t from ) {
 	if(strlen(Cmd_Argv(1)) > 128)
 		return;
 
-	Q_strncpyz( infostring, Cvar_InfoString( CVAR_SERVERINFO ), sizeof( infostring ) );
+	SV_BuildQueryCache();
 
 	// echo back the parameter to status. so master servers can use it as a challenge
 	// to prevent timed spoofed reply packets that add ghost servers
-	Info_SetValueForKey( infostring, "challenge", Cmd_Argv(1) );
-
-	status[0] = 0;
-	statusLength = 0;
-
-	for (i=0 ; i < sv_maxclients->integer ; i++) {
-		cl = &svs.clients[i];
-		if ( cl->state >= CS_CONNECTED ) {
-			ps = SV_GameClientNum( i );
-			Com_sprintf (player, sizeof(player), "%i %i \"%s\"\n",
-				ps->persistant[PERS_SCORE], cl->ping, cl->name);
-			playerLength = strlen(player);
-			if (statusLength + playerLength >= (int)sizeof(status) ) {
-				break;		// can't hold any more
-			}
-			strcpy (status + statusLength, player);
-			statusLength += playerLength;
-		}
-	}
-
-	NET_OutOfBandPrint( NS_SERVER, from, "statusResponse\n%s\n%s", infostring, status );
+	const char *pieces[] = { "statusResponse\n", challenge, svQueryCache.serverInfo, "\n", svQueryCache.players };
+	const int lengths[] = { (int)strlen( pieces[0] ), SV_FormatChallenge( challenge, sizeof( challenge ), Cmd_Argv(1), svQueryCache.serverInfoLength ),
+		svQueryCache.serverInfoLength, 1, svQueryCache.playersLength };
+	SV_SendQueryResponse( from, pieces, lengths, ARRAY_LEN( pieces ) );
 }
 
 /*
@@ -543,9 +685,7 @@ if a user is interested in a server to do a full status
 ================
 */
 void SVC_Info( netadr_t from ) {
-	int		i, count, humans, wDisable;
-	char	*gamedir;
-	char	infostring[MAX_INFO_STRING];
+	char	challenge[160];
 
 	// ignore if we are in single player
 	/*
@@ -584,58 +724,14 @@ void SVC_Info( netadr_t from ) {
 	if(strlen(Cmd_Argv(1)) > 128)
 		return;
 
-	// don't count privateclients
-	count = humans = 0;
-	for ( i = sv_privateClients->integer ; i < sv_maxclients->integer ; i++ ) {
-		if ( svs.clients[i].state >= CS_CONNECTED ) {
-			count++;
-			if ( svs.clients[i].netchan.remoteAddress.type != NA_BOT ) {
-				humans++;
-			}
-		}
-	}
-
-	infostring[0] = 0;
+	SV_BuildQueryCache();
 
 	// echo back the parameter to status. so servers can use it as a challenge
 	// to prevent timed spoofed reply packets that add ghost servers
-	Info_SetValueForKey( infostring, "challenge", Cmd_Argv(1) );
-
-	Info_SetValueForKey( infostring, "protocol", va("%i", PROTOCOL_VERSION) );
-	Info_SetValueForKey( infostring, "hostname", sv_hostname->string );
-	Info_SetValueForKey( infostring, "mapname", sv_mapname->string );
-	Info_SetValueForKey( infostring, "clients", va("%i", count) );
-	Info_SetValueForKey( infostring, "g_humanplayers", va("%i", humans) );
-	Info_SetValueForKey( infostring, "sv_maxclients",
-		va("%i", sv_maxclients->integer - sv_privateClients->integer ) );
-	Info_SetValueForKey( infostring, "gametype", va("%i", sv_gametype->integer ) );
-	Info_SetValueForKey( infostring, "needpass", va("%i", sv_needpass->integer ) );
-	Info_SetValueForKey( infostring, "truejedi", va("%i", Cvar_VariableIntegerValue( "g_jediVmerc" ) ) );
-	if ( sv_gametype->integer == GT_DUEL || sv_gametype->integer == GT_POWERDUEL )
-	{
-		wDisable = Cvar_VariableIntegerValue( "g_duelWeaponDisable" );
-	}
-	else
-	{
-		wDisable = Cvar_VariableIntegerValue( "g_weaponDisable" );
-	}
-	Info_SetValueForKey( infostring, "wdisable", va("%i", wDisable ) );
-	Info_SetValueForKey( infostring, "fdisable", va("%i", Cvar_VariableIntegerValue( "g_forcePowerDisable" ) ) );
-	//Info_SetValueForKey( infostring, "pure", va("%i", sv_pure->integer ) );
-	Info_SetValueForKey( infostring, "autodemo", va("%i", sv_autoDemo->integer ) );
-
-	if( sv_minPing->integer ) {
-		Info_SetValueForKey( infostring, "minPing", va("%i", sv_minPing->integer) );
-	}
-	if( sv_maxPing->integer ) {
-		Info_SetValueForKey( infostring, "maxPing", va("%i", sv_maxPing->integer) );
-	}
-	gamedir = Cvar_VariableString( "fs_game" );
-	if( *gamedir ) {
-		Info_SetValueForKey( infostring, "game", gamedir );
-	}
-
-	NET_OutOfBandPrint( NS_SERVER, from, "infoResponse\n%s", infostring );
+	const char *pieces[] = { "infoResponse\n", svQueryCache.info, challenge };
+	const int lengths[] = { (int)strlen( pieces[0] ), svQueryCache.infoLength,
+		SV_FormatChallenge( challenge, sizeof( challenge ), Cmd_Argv(1), svQueryCache.infoLength ) };
+	SV_SendQueryResponse( from, pieces, lengths, ARRAY_LEN( pieces ) );
 }
 
 /*
@@ -719,6 +815,9 @@ void SVC_RemoteCommand( netadr_t from, msg_t *msg ) {
 		Q_strcat( remaining, sizeof(remaining), cmd_aux);
 
 		Cmd_ExecuteString (remaining);
+
+		// the command may have changed anything the query responses show
+		SV_InvalidateQueryCache();
 	}
 
 	Com_EndRedirect ();
@@ -1136,6 +1235,20 @@ int SV_FrameMsec()
 		return 1;
 }
 
+/*
+==================
+SV_FramePeriodMsec
+Return the length of one server frame in milliseconds.
+==================
+*/
+int SV_FramePeriodMsec( void )
+{
+	if ( !sv_fps || sv_fps->integer < 1 ) {
+		return 100;
+	}
+	return Q_max( 1, (int)( 1000.0f / sv_fps->value ) );
+}
+
 /*
 ==================
 SV_Frame
@@ -1223,7 +1336,11 @@ void SV_Frame( int msec ) {
 
 	if (com_dedicated->integer) SV_BotFrame( sv.time );
 
+	// synthetic load test clients send their usercmds
+	SV_LoadTestThink();
+
 	// run the game simulation in chunks
+	const loadTestTimer_t gameTimer = SV_LoadTestTimerStart();
 	while ( sv.timeResidual >= frameMsec ) {
 		sv.timeResidual -= frameMsec;
 		svs.time += frameMsec;
@@ -1232,6 +1349,7 @@ void SV_Frame( int msec ) {
 		// let everything in the world think and move
 		GVM_RunFrame( sv.time );
 	}
+	SV_LoadTestTimerStop( gameTimer, LOADTEST_GAME );
 
 	//rww - RAGDOLL_BEGIN
 	g2api->G2API_SetTime(sv.time,0);
@@ -1245,12 +1363,16 @@ void SV_Frame( int msec ) {
 	SV_CheckTimeouts();
 
 	// send messages back to the clients
+	const loadTestTimer_t sendTimer = SV_LoadTestTimerStart();
 	SV_SendClientMessages();
+	SV_LoadTestTimerStop( sendTimer, LOADTEST_SEND );
 
 	SV_CheckCvars();
 
 	// send a heartbeat to the master if needed
 	SV_MasterHeartbeat();
+
+	SV_LoadTestEndFrame();
 }
 
 //============================================================================
@@ -137,6 +137,11 @@ static void SV_WriteSnapshotToClient( client_t *client, msg_t *msg ) {
 		client->deltaMessage = client->netchan.outgoingSequence;
 	}
 
+	// periodically give the demo a non-delta snapshot to seek to
+	if ( SV_DemoKeyframeDue( client ) ) {
+		client->demo.demowaiting = qtrue;
+	}
+
 	// try to use a previous frame as the source for delta compressing the snapshot
 	if ( deltaMessage <= 0 || client->state != CS_ACTIVE ) {
 		// client is asking for a retransmit
@@ -177,6 +182,10 @@ static void SV_WriteSnapshotToClient( client_t *client, msg_t *msg ) {
 			client->demo.minDeltaFrame = client->netchan.outgoingSequence;
 		}
 		client->demo.demowaiting = qfalse;
+		if ( client->demo.demorecording ) {
+			client->demo.keyframe = qtrue;
+			client->demo.nextKeyframeTime = sv.time + sv_demoKeyframeInterval->integer;
+		}
 	}
 
 	MSG_WriteByte (msg, svc_snapshot);
@@ -702,6 +711,8 @@ void SV_SendMessageToClient( msg_t *msg, client_t *client ) {
 		SV_Netchan_TransmitNextFragment(&client->netchan);
 	}
 
+	SV_LoadTestCountBytes( msg->cursize );
+
 	// record information about the message
 	client->frames[client->netchan.outgoingSequence & PACKET_MASK].messageSize = msg->cursize;
 	client->frames[client->netchan.outgoingSequence & PACKET_MASK].messageSent = svs.time;
@@ -826,7 +837,8 @@ void SV_SendClientSnapshot( client_t *client ) {
 
 	// bots need to have their snapshots built, but
 	// they query them directly without needing to be sent
-	if ( client->netchan.remoteAddress.type == NA_BOT && !client->demo.demorecording ) {
+	// load test players write theirs so they can be measured, see SV_SendMessageToClient
+	if ( client->netchan.remoteAddress.type == NA_BOT && !client->demo.demorecording && !client->loadTest ) {
 		return;
 	}
 
@@ -877,6 +877,25 @@ Ghoul2 Insert End
 	*results = clip.trace;
 }
 
+/*
+==================
+SV_TraceWorld
+
+SV_Trace against the world alone, for callers that already know no entity is in reach
+==================
+*/
+void SV_TraceWorld( trace_t *results, const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, int contentmask, int capsule ) {
+	if ( !mins ) {
+		mins = vec3_origin;
+	}
+	if ( !maxs ) {
+		maxs = vec3_origin;
+	}
+
+	CM_BoxTrace( results, start, end, mins, maxs, 0, contentmask, capsule );
+	results->entityNum = results->fraction != 1.0 ? ENTITYNUM_WORLD : ENTITYNUM_NONE;
+}
+
 
 
 /*
@@ -150,6 +150,10 @@ void	Sys_FreeFileList( char **fileList );
 
 time_t Sys_FileTime( const char *path );
 
+// read only, shared mapping of a whole file; NULL if it can't be mapped
+void	*Sys_MapFile( const char *path, size_t *length );
+void	Sys_UnmapFile( void *data, size_t length );
+
 qboolean Sys_LowPhysicalMemory();
 
 void Sys_SetProcessorAffinity( void );
@@ -26,6 +26,7 @@ along with this program; if not, see <http://www.gnu.org/licenses/>.
 #include <errno.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <pwd.h>
@@ -442,6 +443,42 @@ bool Sys_PathCmp( const char *path1, const char *path2 )
 	return false;
 }
 
+/*
+==================
+Sys_MapFile
+
+Pages are shared with every other process mapping the same file
+==================
+*/
+void *Sys_MapFile( const char *path, size_t *length )
+{
+	struct stat st;
+	void *data;
+	int fd;
+
+	fd = open( path, O_RDONLY );
+	if ( fd < 0 )
+		return NULL;
+
+	if ( fstat( fd, &st ) != 0 || st.st_size <= 0 ) {
+		close( fd );
+		return NULL;
+	}
+
+	data = mmap( NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+	close( fd );
+	if ( data == MAP_FAILED )
+		return NULL;
+
+	*length = st.st_size;
+	return data;
+}
+
+void Sys_UnmapFile( void *data, size_t length )
+{
+	munmap( data, length );
+}
+
 /*
 ==================
 Sys_DefaultHomePath
@@ -290,6 +290,46 @@ bool Sys_PathCmp( const char *path1, const char *path2 ) {
 	return false;
 }
 
+/*
+==============
+Sys_MapFile
+
+Pages are shared with every other process mapping the same file
+==============
+*/
+void *Sys_MapFile( const char *path, size_t *length ) {
+	HANDLE file, mapping;
+	LARGE_INTEGER size;
+	void *data;
+
+	file = CreateFile( path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+	if ( file == INVALID_HANDLE_VALUE )
+		return NULL;
+
+	if ( !GetFileSizeEx( file, &size ) || size.QuadPart <= 0 ) {
+		CloseHandle( file );
+		return NULL;
+	}
+
+	mapping = CreateFileMapping( file, NULL, PAGE_READONLY, 0, 0, NULL );
+	CloseHandle( file );
+	if ( !mapping )
+		return NULL;
+
+	// the view keeps the mapping alive
+	data = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+	CloseHandle( mapping );
+	if ( !data )
+		return NULL;
+
+	*length = (size_t)size.QuadPart;
+	return data;
+}
+
+void Sys_UnmapFile( void *data, size_t length ) {
+	UnmapViewOfFile( data );
+}
+
 /*
 ==============================================================
 